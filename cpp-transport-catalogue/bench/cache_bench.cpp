@@ -0,0 +1,147 @@
+// Кэш ответов на запросы к базе на синтетическом городе: время пачки без кэша
+// и с кэшем разного размера (холодным и прогретым), доля попаданий, вытеснения,
+// совпадение ответов с ответами без кэша и сброс при смене версии справочника
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "../input_reader.h"
+#include "../output_writer.h"
+#include "../parallel.h"
+#include "../response_cache.h"
+#include "../spatial_index.h"
+#include "../stat_reader.h"
+#include "../transport_catalogue.h"
+#include "../transport_router.h"
+#include "city_generator.h"
+
+using namespace std;
+using namespace transport_catalogue;
+
+namespace {
+
+struct Database {
+    const TransportCatalogue& catalogue;
+    const router::TransportRouter& router;
+    const SpatialIndex& spatial_index;
+};
+
+struct BatchResult {
+    double milliseconds = 0;
+    string output;
+};
+
+BatchResult RunBatch(const Database& database, const vector<string_view>& requests, unsigned thread_count,
+                     stat_p::ResponseCache* cache, uint64_t version) {
+    output::Writer output;
+    const auto start = chrono::steady_clock::now();
+    stat_p::ParseAndPrintStats(database.catalogue, requests, output, thread_count, &database.router,
+                               &database.spatial_index, nullptr, cache, version);
+    return {chrono::duration<double, milli>(chrono::steady_clock::now() - start).count(), string(output.View())};
+}
+
+void Report(string_view name, const BatchResult& result, const BatchResult& reference,
+            const stat_p::ResponseCache::Stats* stats = nullptr) {
+    cout << "  " << left << setw(24) << name << right << fixed << setprecision(1) << setw(9) << result.milliseconds
+         << " ms" << setw(7) << setprecision(2) << reference.milliseconds / result.milliseconds << "x";
+    if (stats) {
+        cout << setprecision(1) << setw(7) << stats->HitRate() * 100 << "% hits, " << stats->stale << " stale, "
+             << stats->evictions << " evictions";
+    }
+    cout << (result.output == reference.output ? "" : "  OUTPUT DIFFERS") << "\n" << defaultfloat;
+}
+
+} // namespace
+
+/**
+ * Параметры (все необязательные):
+ *   --seed N --stops N --buses N --stat-requests N --route-ratio X --nearby-ratio X --threads N
+ */
+int main(int argc, char* argv[]) {
+    bench::CityOptions options;
+    options.stop_count = 20'000;
+    options.bus_count = 2'000;
+    options.stat_request_count = 400'000;
+    // Nearby почти не повторяются и заслонили бы повторы Bus и Stop
+    options.nearby_request_ratio = 0;
+    unsigned thread_count = parallel::DefaultThreadCount();
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const string_view option = argv[i];
+        const string value = argv[i + 1];
+        if (option == "--seed") {
+            options.seed = stoul(value);
+        } else if (option == "--stops") {
+            options.stop_count = stoul(value);
+        } else if (option == "--buses") {
+            options.bus_count = stoul(value);
+        } else if (option == "--stat-requests") {
+            options.stat_request_count = stoul(value);
+        } else if (option == "--route-ratio") {
+            options.route_request_ratio = stod(value);
+        } else if (option == "--nearby-ratio") {
+            options.nearby_request_ratio = stod(value);
+        } else if (option == "--threads") {
+            thread_count = stoul(value);
+        } else {
+            cerr << "Unknown option: " << option << "\n";
+            return 1;
+        }
+    }
+
+    const bench::City city = bench::GenerateCity(options);
+    TransportCatalogue catalogue;
+    {
+        vector<string_view> lines(city.base_requests.begin(), city.base_requests.end());
+        input::Reader reader;
+        reader.ParseLines(lines, 1);
+        reader.ApplyCommands(catalogue, 1);
+    }
+    const router::TransportRouter transport_router(catalogue, router::RoutingSettings{});
+    const SpatialIndex spatial_index(catalogue);
+    const Database database{catalogue, transport_router, spatial_index};
+
+    const vector<string_view> requests(city.stat_requests.begin(), city.stat_requests.end());
+    const unordered_set<string_view> distinct(requests.begin(), requests.end());
+    cout << "stops: " << options.stop_count << ", buses: " << options.bus_count << ", requests: " << requests.size()
+         << ", distinct: " << distinct.size() << ", threads: " << thread_count << "\n";
+
+    vector<unsigned> thread_counts{1};
+    if (thread_count > 1) {
+        thread_counts.push_back(thread_count);
+    }
+    for (unsigned threads : thread_counts) {
+        cout << "threads " << threads << ":\n";
+        const BatchResult reference = RunBatch(database, requests, threads, nullptr, 0);
+        Report("no cache", reference, reference);
+
+        for (size_t capacity : {distinct.size() / 10, distinct.size() / 2, distinct.size() * 2}) {
+            stat_p::ResponseCache cache(capacity);
+            const string name = "cache " + to_string(capacity);
+            const BatchResult cold = RunBatch(database, requests, threads, &cache, 1);
+            auto stats = cache.GetStats();
+            Report(name + ", cold", cold, reference, &stats);
+
+            const BatchResult warm = RunBatch(database, requests, threads, &cache, 1);
+            auto warm_stats = cache.GetStats();
+            warm_stats.hits -= stats.hits;
+            warm_stats.misses -= stats.misses;
+            warm_stats.stale -= stats.stale;
+            warm_stats.evictions -= stats.evictions;
+            Report(name + ", warm", warm, reference, &warm_stats);
+
+            // Новая версия справочника: все прежние ответы устарели
+            const BatchResult next = RunBatch(database, requests, threads, &cache, 2);
+            auto next_stats = cache.GetStats();
+            next_stats.hits -= stats.hits + warm_stats.hits;
+            next_stats.misses -= stats.misses + warm_stats.misses;
+            next_stats.stale -= stats.stale + warm_stats.stale;
+            next_stats.evictions -= stats.evictions + warm_stats.evictions;
+            Report(name + ", new version", next, reference, &next_stats);
+        }
+    }
+    return 0;
+}
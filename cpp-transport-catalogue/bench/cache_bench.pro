@@ -0,0 +1,35 @@
+CONFIG += c++20 cmdline
+CONFIG -= qt
+CONFIG += thread
+QMAKE_CXXFLAGS += -ffp-contract=off
+
+SOURCES += \
+    cache_bench.cpp \
+    city_generator.cpp \
+    ../contraction_hierarchy.cpp \
+    ../departure_board.cpp \
+    ../geo.cpp \
+    ../input_reader.cpp \
+    ../name_interner.cpp \
+    ../output_writer.cpp \
+    ../response_cache.cpp \
+    ../spatial_index.cpp \
+    ../stat_reader.cpp \
+    ../transport_catalogue.cpp \
+    ../transport_router.cpp
+
+HEADERS += \
+    city_generator.h \
+    ../command_table.h \
+    ../contraction_hierarchy.h \
+    ../departure_board.h \
+    ../geo.h \
+    ../input_reader.h \
+    ../name_interner.h \
+    ../output_writer.h \
+    ../parallel.h \
+    ../response_cache.h \
+    ../spatial_index.h \
+    ../stat_reader.h \
+    ../transport_catalogue.h \
+    ../transport_router.h
@@ -0,0 +1,269 @@
+// Сквозной замер на синтетическом городе: разбор, построение справочника,
+// задержки запросов и их перцентили, выделения памяти и RSS по фазам.
+// С --emit FILE только записывает сгенерированный ввод для main_
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../input_reader.h"
+#include "../output_writer.h"
+#include "../parallel.h"
+#include "../spatial_index.h"
+#include "../stat_reader.h"
+#include "../transport_catalogue.h"
+#include "../transport_router.h"
+#include "city_generator.h"
+
+using namespace std;
+using namespace transport_catalogue;
+
+namespace {
+
+atomic<size_t> allocation_count = 0;
+atomic<size_t> allocated_bytes = 0;
+
+} // namespace
+
+// Подсчёт выделений памяти во всей программе. Остальные формы new и delete
+// стандартной библиотеки сводятся к этим
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    allocated_bytes.fetch_add(size, memory_order_relaxed);
+    if (void* pointer = malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+#pragma GCC diagnostic pop
+
+namespace {
+
+// Текущий и пиковый RSS в килобайтах из /proc/self/status
+pair<size_t, size_t> ReadRss() {
+    ifstream status("/proc/self/status");
+    size_t rss = 0;
+    size_t peak = 0;
+    for (string line; getline(status, line);) {
+        if (line.starts_with("VmRSS:")) {
+            rss = stoul(line.substr(6));
+        } else if (line.starts_with("VmHWM:")) {
+            peak = stoul(line.substr(6));
+        }
+    }
+    return {rss, peak};
+}
+
+// Сбрасывает пиковый RSS до текущего, чтобы пик считался для каждой фазы отдельно
+void ResetPeakRss() {
+    ofstream("/proc/self/clear_refs") << "5";
+}
+
+// Время, число и объём выделений памяти, RSS после фазы и её пиковый RSS
+template <typename Func>
+void MeasurePhase(string_view name, Func func) {
+    ResetPeakRss();
+    const size_t count_before = allocation_count.load();
+    const size_t bytes_before = allocated_bytes.load();
+    const auto start = chrono::steady_clock::now();
+    func();
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    const size_t count = allocation_count.load() - count_before;
+    const size_t bytes = allocated_bytes.load() - bytes_before;
+    const auto [rss, peak] = ReadRss();
+    cout << left << setw(10) << name << right << fixed << setprecision(1) << setw(10) << seconds * 1e3 << " ms"
+         << setw(12) << count << " allocs" << setw(10) << bytes / 1024.0 / 1024.0 << " MiB allocated" << setw(9)
+         << rss / 1024.0 << " MiB RSS" << setw(9) << peak / 1024.0 << " MiB peak\n"
+         << defaultfloat;
+}
+
+// Задержки одного вида запросов, наносекунды
+struct Latencies {
+    string_view name;
+    vector<double> samples;
+
+    void Print() {
+        if (samples.empty()) {
+            return;
+        }
+        sort(samples.begin(), samples.end());
+        auto percentile = [this](double p) {
+            return samples[min(samples.size() - 1, static_cast<size_t>(p * samples.size()))] / 1e3;
+        };
+        cout << "  " << left << setw(24) << name << right << setw(9) << samples.size() << " queries, us: p50 "
+             << fixed << setprecision(2) << percentile(0.5) << ", p90 " << percentile(0.9) << ", p99 "
+             << percentile(0.99) << ", p99.9 " << percentile(0.999) << ", max " << samples.back() / 1e3 << "\n"
+             << defaultfloat;
+    }
+};
+
+template <typename Func>
+void Sample(Latencies& latencies, Func func) {
+    const auto start = chrono::steady_clock::now();
+    func();
+    latencies.samples.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+}
+
+} // namespace
+
+/**
+ * Параметры (все необязательные):
+ *   --seed N --stops N --buses N --min-route N --max-route N --roundtrip-ratio X
+ *   --distance-density X --stat-requests N --missing-ratio X --route-ratio X --nearby-ratio X
+ *   --threads N           потоки разбора и построения (по умолчанию все ядра)
+ *   --load MODE           batch (по умолчанию) - разбор всех строк и построение,
+ *                         streaming - StreamingReader применяет строки по одной
+ *   --emit FILE           записать ввод для main_ и выйти
+ */
+int main(int argc, char* argv[]) {
+    bench::CityOptions options;
+    unsigned thread_count = parallel::DefaultThreadCount();
+    string emit_path;
+    bool streaming = false;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const string_view option = argv[i];
+        const string value = argv[i + 1];
+        if (option == "--seed") {
+            options.seed = stoul(value);
+        } else if (option == "--stops") {
+            options.stop_count = stoul(value);
+        } else if (option == "--buses") {
+            options.bus_count = stoul(value);
+        } else if (option == "--min-route") {
+            options.min_route_stops = stoul(value);
+        } else if (option == "--max-route") {
+            options.max_route_stops = stoul(value);
+        } else if (option == "--roundtrip-ratio") {
+            options.roundtrip_ratio = stod(value);
+        } else if (option == "--distance-density") {
+            options.distance_density = stod(value);
+        } else if (option == "--stat-requests") {
+            options.stat_request_count = stoul(value);
+        } else if (option == "--missing-ratio") {
+            options.missing_ratio = stod(value);
+        } else if (option == "--route-ratio") {
+            options.route_request_ratio = stod(value);
+        } else if (option == "--nearby-ratio") {
+            options.nearby_request_ratio = stod(value);
+        } else if (option == "--threads") {
+            thread_count = max(1, stoi(value));
+        } else if (option == "--load") {
+            if (value != "batch" && value != "streaming") {
+                cerr << "Unknown load mode: " << value << "\n";
+                return 1;
+            }
+            streaming = value == "streaming";
+        } else if (option == "--emit") {
+            emit_path = value;
+        } else {
+            cerr << "Unknown option: " << option << "\n";
+            return 1;
+        }
+    }
+
+    const bench::City city = bench::GenerateCity(options);
+    if (!emit_path.empty()) {
+        ofstream output(emit_path);
+        city.Write(output);
+        return output ? 0 : 1;
+    }
+
+    cout << "stops: " << options.stop_count << ", buses: " << options.bus_count << ", stat requests: "
+         << city.stat_requests.size() << ", threads: " << thread_count << ", load: "
+         << (streaming ? "streaming" : "batch") << "\n";
+
+    auto catalogue = make_unique<TransportCatalogue>();
+    if (streaming) {
+        MeasurePhase("load", [&] {
+            input::StreamingReader reader(*catalogue);
+            for (const string& line : city.base_requests) {
+                reader.ApplyLine(line);
+            }
+            reader.Finish(thread_count);
+        });
+    } else {
+        vector<string_view> lines(city.base_requests.begin(), city.base_requests.end());
+        auto reader = make_unique<input::Reader>();
+        MeasurePhase("parse", [&] { reader->ParseLines(lines, thread_count); });
+        MeasurePhase("build", [&] {
+            reader->ApplyCommands(*catalogue, thread_count);
+            reader.reset();
+        });
+    }
+
+    unique_ptr<router::TransportRouter> transport_router;
+    unique_ptr<SpatialIndex> spatial_index;
+    if (options.route_request_ratio > 0 || options.nearby_request_ratio > 0) {
+        MeasurePhase("indexes", [&] {
+            if (options.route_request_ratio > 0) {
+                transport_router = make_unique<router::TransportRouter>(*catalogue, router::RoutingSettings{});
+            }
+            if (options.nearby_request_ratio > 0) {
+                spatial_index = make_unique<SpatialIndex>(*catalogue);
+            }
+        });
+    }
+
+    // Прямые вызовы справочника и полный путь запроса с разбором и форматированием ответа
+    Latencies route_information{"RouteInformation", {}};
+    Latencies buses_for_stop{"GetBusesForStop", {}};
+    vector<Latencies> stats{{"Bus request", {}}, {"Stop request", {}}, {"Route request", {}}, {"Nearby request", {}}};
+    for (auto& latencies : stats) {
+        latencies.samples.reserve(city.stat_requests.size());
+    }
+    route_information.samples.reserve(city.stat_requests.size());
+    buses_for_stop.samples.reserve(city.stat_requests.size());
+    MeasurePhase("queries", [&] {
+        output::Writer output;
+        for (const string& request : city.stat_requests) {
+            const string_view text = request;
+            if (text.starts_with("Bus ")) {
+                Sample(route_information, [&] { catalogue->RouteInformation(text.substr(4)); });
+            } else if (text.starts_with("Stop ")) {
+                Sample(buses_for_stop, [&] { catalogue->GetBusesForStop(text.substr(5)); });
+            }
+            const size_t kind = text.starts_with("Bus ")     ? 0
+                                : text.starts_with("Stop ")  ? 1
+                                : text.starts_with("Route ") ? 2
+                                                             : 3;
+            Sample(stats[kind], [&] {
+                stat_p::ParseAndPrintStat(*catalogue, text, output, transport_router.get(), spatial_index.get());
+            });
+            output.Clear();
+        }
+    });
+
+    MeasurePhase("destroy", [&] {
+        spatial_index.reset();
+        transport_router.reset();
+        catalogue.reset();
+    });
+
+    cout << "latency per query:\n";
+    route_information.Print();
+    buses_for_stop.Print();
+    for (auto& latencies : stats) {
+        latencies.Print();
+    }
+    return 0;
+}
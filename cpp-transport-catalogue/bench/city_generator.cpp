@@ -0,0 +1,225 @@
+#include "city_generator.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <unordered_set>
+
+#include "../geo.h"
+
+namespace bench {
+
+namespace {
+
+constexpr double kCenterLat = 55.75;
+constexpr double kCenterLng = 37.62;
+constexpr double kStepMeters = 400;
+
+// Узел сетки: остановка i стоит в строке i / side, столбце i % side
+struct Grid {
+    size_t side;
+    size_t count;
+
+    size_t Row(size_t stop) const {
+        return stop / side;
+    }
+    size_t Column(size_t stop) const {
+        return stop % side;
+    }
+
+    // Сосед в направлении direction (0 - север, 1 - восток, 2 - юг, 3 - запад) или count, если его нет
+    size_t Neighbour(size_t stop, int direction) const {
+        const size_t row = Row(stop);
+        const size_t column = Column(stop);
+        size_t next = count;
+        if (direction == 0 && row > 0) {
+            next = stop - side;
+        } else if (direction == 1 && column + 1 < side) {
+            next = stop + 1;
+        } else if (direction == 2) {
+            next = stop + side;
+        } else if (direction == 3 && column > 0) {
+            next = stop - 1;
+        }
+        return next < count ? next : count;
+    }
+};
+
+std::vector<std::string> GenerateNames(size_t count, std::mt19937& random) {
+    static const char* const kSyllables[] = {"ka", "ro", "vo", "li", "na", "mi", "de", "sto", "pra", "zhe",
+                                             "ti", "lu", "gor", "bel", "yar", "shi", "ve", "ol", "dan", "rus"};
+    static const char* const kKinds[] = {"Street", "Avenue", "Square", "Lane", "Park", "Station", "Bridge", "Market"};
+    constexpr size_t kSyllableCount = std::size(kSyllables);
+    constexpr size_t kKindCount = std::size(kKinds);
+
+    std::vector<std::string> names;
+    std::unordered_set<std::string> used;
+    names.reserve(count);
+    while (names.size() < count) {
+        std::string name;
+        const size_t syllables = 2 + random() % 3;
+        for (size_t i = 0; i < syllables; ++i) {
+            name += kSyllables[random() % kSyllableCount];
+        }
+        name[0] = static_cast<char>(name[0] - 'a' + 'A');
+        name += ' ';
+        name += kKinds[random() % kKindCount];
+        if (!used.insert(name).second) {
+            name += ' ' + std::to_string(names.size());
+            used.insert(name);
+        }
+        names.push_back(std::move(name));
+    }
+    return names;
+}
+
+// Маршрут - блуждание по сетке, чаще прямо, без разворотов на месте.
+// Кольцевой маршрут на второй половине возвращается к началу
+std::vector<size_t> GenerateRoute(const Grid& grid, size_t length, bool roundtrip, std::mt19937& random) {
+    std::vector<size_t> route{random() % grid.count};
+    int direction = static_cast<int>(random() % 4);
+    const size_t outward = roundtrip ? (length + 1) / 2 : length;
+    while (route.size() < outward) {
+        if (random() % 10 < 3) {
+            direction = (direction + (random() % 2 ? 1 : 3)) % 4;
+        }
+        size_t next = grid.Neighbour(route.back(), direction);
+        for (int turn = 1; next == grid.count && turn < 4; ++turn) {
+            next = grid.Neighbour(route.back(), (direction + turn) % 4);
+        }
+        if (next == grid.count) {
+            break;
+        }
+        route.push_back(next);
+    }
+    if (roundtrip) {
+        // Обратный путь приближается к началу сначала по столбцам, потом по строкам.
+        // Узла нет только в неполной последней строке - тогда шаг делается на север
+        const size_t start = route.front();
+        while (route.back() != start) {
+            const size_t current = route.back();
+            size_t next = grid.count;
+            if (grid.Column(current) != grid.Column(start)) {
+                next = grid.Neighbour(current, grid.Column(current) > grid.Column(start) ? 3 : 1);
+            }
+            if (next == grid.count) {
+                next = grid.Neighbour(current, grid.Row(current) > grid.Row(start) ? 0 : 2);
+            }
+            route.push_back(next);
+        }
+    }
+    return route;
+}
+
+} // namespace
+
+
+void City::Write(std::ostream& output) const {
+    output << base_requests.size() << "\n";
+    for (const auto& request : base_requests) {
+        output << request << "\n";
+    }
+    output << stat_requests.size() << "\n";
+    for (const auto& request : stat_requests) {
+        output << request << "\n";
+    }
+}
+
+City GenerateCity(const CityOptions& options) {
+    std::mt19937 random(options.seed);
+    std::uniform_real_distribution<double> unit(0, 1);
+
+    const Grid grid{std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(options.stop_count)))),
+                    options.stop_count};
+    const std::vector<std::string> names = GenerateNames(options.stop_count, random);
+
+    // Шаг сетки растёт от центра к окраинам, узлы сдвинуты случайно
+    std::vector<geo::Coordinates> coordinates(options.stop_count);
+    const double lat_step = kStepMeters / (geo::kEarthRadius * geo::kDegToRad);
+    const double lng_step = lat_step / std::cos(kCenterLat * geo::kDegToRad);
+    const double half = grid.side / 2.0;
+    for (size_t stop = 0; stop < options.stop_count; ++stop) {
+        const double y = (grid.Row(stop) - half) / std::max(half, 1.0);
+        const double x = (grid.Column(stop) - half) / std::max(half, 1.0);
+        const double stretch = half * (0.6 + 0.4 * std::hypot(x, y));
+        coordinates[stop] = {kCenterLat + (y * stretch + (unit(random) - 0.5) * 0.6) * lat_step,
+                             kCenterLng + (x * stretch + (unit(random) - 0.5) * 0.6) * lng_step};
+    }
+
+    std::vector<std::vector<size_t>> routes(options.bus_count);
+    std::vector<bool> roundtrips(options.bus_count);
+    const size_t length_range = options.max_route_stops - std::min(options.min_route_stops, options.max_route_stops) + 1;
+    for (size_t bus = 0; bus < options.bus_count && options.stop_count > 0; ++bus) {
+        roundtrips[bus] = unit(random) < options.roundtrip_ratio;
+        const size_t length = std::max<size_t>(2, options.min_route_stops + random() % length_range);
+        routes[bus] = GenerateRoute(grid, length, roundtrips[bus], random);
+    }
+
+    // Дорожные расстояния перегонов; повторно встреченный перегон сохраняет первое значение
+    std::vector<std::vector<std::pair<size_t, int>>> distances(options.stop_count);
+    std::unordered_set<uint64_t> known;
+    auto add_distance = [&](size_t from, size_t to, int meters) {
+        if (known.insert(static_cast<uint64_t>(from) << 32 | to).second) {
+            distances[from].emplace_back(to, meters);
+        }
+    };
+    auto road_meters = [&](size_t from, size_t to) {
+        const double geo_meters = geo::ComputeDistance(coordinates[from], coordinates[to]);
+        return std::max(1, static_cast<int>(geo_meters * (1.1 + 0.5 * unit(random))));
+    };
+    for (const auto& route : routes) {
+        for (size_t i = 0; i + 1 < route.size(); ++i) {
+            const size_t from = route[i];
+            const size_t to = route[i + 1];
+            if (from == to || unit(random) >= options.distance_density) {
+                continue;
+            }
+            add_distance(from, to, road_meters(from, to));
+            if (unit(random) < options.reverse_distance_ratio) {
+                add_distance(to, from, road_meters(to, from));
+            }
+        }
+    }
+
+    City city;
+    for (size_t stop = 0; stop < options.stop_count; ++stop) {
+        std::string line = "Stop " + names[stop] + ": " + std::to_string(coordinates[stop].lat) + ", "
+                           + std::to_string(coordinates[stop].lng);
+        for (const auto& [to, meters] : distances[stop]) {
+            line += ", " + std::to_string(meters) + "m to " + names[to];
+        }
+        city.base_requests.push_back(std::move(line));
+    }
+    for (size_t bus = 0; bus < options.bus_count; ++bus) {
+        std::string line = "Bus " + std::to_string(bus + 1) + ": ";
+        for (size_t i = 0; i < routes[bus].size(); ++i) {
+            if (i > 0) {
+                line += roundtrips[bus] ? " > " : " - ";
+            }
+            line += names[routes[bus][i]];
+        }
+        city.base_requests.push_back(std::move(line));
+    }
+    // Остановки и маршруты во входных данных перемешаны
+    std::shuffle(city.base_requests.begin(), city.base_requests.end(), random);
+
+    for (size_t i = 0; i < options.stat_request_count && options.stop_count > 0; ++i) {
+        const double kind = unit(random);
+        const bool missing = unit(random) < options.missing_ratio;
+        const std::string& stop_name = names[random() % options.stop_count];
+        if (kind < options.route_request_ratio) {
+            city.stat_requests.push_back("Route " + stop_name + " to " + names[random() % options.stop_count]);
+        } else if (kind < options.route_request_ratio + options.nearby_request_ratio) {
+            const geo::Coordinates& center = coordinates[random() % options.stop_count];
+            city.stat_requests.push_back("Nearby " + std::to_string(center.lat) + ", " + std::to_string(center.lng)
+                                         + ", " + std::to_string(200 + random() % 1300));
+        } else if (random() % 2 == 0 && options.bus_count > 0) {
+            const size_t bus = missing ? options.bus_count + 1 + random() % 1000 : 1 + random() % options.bus_count;
+            city.stat_requests.push_back("Bus " + std::to_string(bus));
+        } else {
+            city.stat_requests.push_back(missing ? "Stop Nowhere " + std::to_string(i) : "Stop " + stop_name);
+        }
+    }
+    return city;
+}
+
+} // namespace bench
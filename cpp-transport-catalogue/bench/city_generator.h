@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace bench {
+
+struct CityOptions {
+    uint32_t seed = 1;
+    size_t stop_count = 10'000;
+    size_t bus_count = 1'000;
+    size_t min_route_stops = 5;         // без повтора конечной у кольцевых
+    size_t max_route_stops = 30;
+    double roundtrip_ratio = 0.3;       // доля кольцевых маршрутов
+    double distance_density = 0.9;      // доля перегонов с заданным дорожным расстоянием,
+                                        // для остальных берётся географическое
+    double reverse_distance_ratio = 0.2;    // доля заданных перегонов с отдельным обратным расстоянием
+    size_t stat_request_count = 100'000;
+    double missing_ratio = 0.02;        // доля запросов к несуществующим остановкам и маршрутам
+    double route_request_ratio = 0;     // доли запросов Route и Nearby среди запросов к базе,
+    double nearby_request_ratio = 0;    // остальные поровну делятся между Bus и Stop
+};
+
+/**
+ * Входные строки справочника в формате main_: запросы на заполнение
+ * и запросы к базе. Одинаковые параметры дают одинаковые строки
+ */
+struct City {
+    std::vector<std::string> base_requests;
+    std::vector<std::string> stat_requests;
+
+    // Записывает ввод для main_: число и строки запросов на заполнение, затем запросов к базе
+    void Write(std::ostream& output) const;
+};
+
+/**
+ * Строит город: остановки стоят на сетке с шагом около 400 м, сгущаясь к центру,
+ * маршрут идёт по соседним узлам сетки, чаще прямо. Дорожное расстояние перегона
+ * на 10-60% больше географического. Названия составлены из слогов, как у улиц
+ */
+City GenerateCity(const CityOptions& options);
+
+} // namespace bench
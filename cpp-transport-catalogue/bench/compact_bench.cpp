@@ -0,0 +1,257 @@
+// Компактный справочник против обычного на синтетическом городе: занятая куча,
+// точность (координаты, расстояния, статистика маршрутов, ответы на запросы)
+// и задержки основных обращений. Отдельно проверяется погрешность координат
+// с полной точностью double по всему земному шару
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <malloc.h>
+
+#include "../compact_catalogue.h"
+#include "../input_reader.h"
+#include "../output_writer.h"
+#include "../spatial_index.h"
+#include "../stat_reader.h"
+#include "../transport_catalogue.h"
+#include "../transport_router.h"
+#include "city_generator.h"
+
+using namespace std;
+using namespace transport_catalogue;
+
+namespace {
+
+size_t HeapInUse() {
+    return mallinfo2().uordblks;
+}
+
+double MiB(size_t bytes) {
+    return static_cast<double>(bytes) / 1024.0 / 1024.0;
+}
+
+// Лучшее из нескольких повторов время на обращение, наносекунды
+template <typename Func>
+double MeasurePerCall(size_t calls, Func func) {
+    constexpr int kRepeats = 3;
+    double best = 1e300;
+    for (int i = 0; i < kRepeats; ++i) {
+        const auto start = chrono::steady_clock::now();
+        func();
+        best = min(best, chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+    }
+    return best / static_cast<double>(max<size_t>(calls, 1));
+}
+
+void ReportLatency(string_view name, double full, double compact) {
+    cout << "  " << left << setw(20) << name << right << fixed << setprecision(1) << setw(9) << full << " ns"
+         << setw(10) << compact << " ns\n"
+         << defaultfloat << setprecision(6);
+}
+
+// Погрешность фиксированной точки на точках с полной точностью double:
+// наибольший сдвиг точки и наибольшая ошибка расстояния между соседними точками, метры
+void CheckCoordinatePrecision(size_t count) {
+    mt19937 random(7);
+    uniform_real_distribution<double> lat(-85, 85);
+    uniform_real_distribution<double> lng(-180, 180);
+    uniform_real_distribution<double> offset(-0.005, 0.005);
+
+    TransportCatalogue catalogue;
+    for (size_t i = 0; i < count; i += 2) {
+        const Coordinates point{lat(random), lng(random)};
+        catalogue.AddStop("P" + to_string(i), point);
+        catalogue.AddStop("P" + to_string(i + 1), {point.lat + offset(random), point.lng + offset(random)});
+    }
+    catalogue.BuildIndexes();
+    const CompactCatalogue compact(catalogue);
+
+    double max_shift = 0;
+    double max_distance_error = 0;
+    for (StopId stop = 0; stop + 1 < catalogue.StopCount(); stop += 2) {
+        const Coordinates from = catalogue.GetStopCoordinates(stop);
+        const Coordinates to = catalogue.GetStopCoordinates(stop + 1);
+        const Coordinates compact_from = compact.GetStopCoordinates(stop);
+        const Coordinates compact_to = compact.GetStopCoordinates(stop + 1);
+        // Сдвиг меряется по осям: acos у совсем близких точек теряет точность
+        const double shift_lat = abs(from.lat - compact_from.lat) * kDegToRad * kEarthRadius;
+        const double shift_lng = abs(from.lng - compact_from.lng) * kDegToRad * kEarthRadius * cos(from.lat * kDegToRad);
+        max_shift = max(max_shift, hypot(shift_lat, shift_lng));
+        max_distance_error = max(max_distance_error,
+                                 abs(ComputeDistance(from, to) - ComputeDistance(compact_from, compact_to)));
+    }
+    cout << "full-precision points: " << catalogue.StopCount() << ", max shift " << max_shift * 1000
+         << " mm (bound 7.9), max neighbour distance error " << max_distance_error * 100 << " cm (bound 1.6)\n";
+}
+
+} // namespace
+
+/**
+ * Параметры (все необязательные):
+ *   --seed N --stops N --buses N --stat-requests N --route-ratio X --nearby-ratio X
+ */
+int main(int argc, char* argv[]) {
+    bench::CityOptions options;
+    options.stop_count = 200'000;
+    options.bus_count = 40'000;
+    options.stat_request_count = 20'000;
+    options.route_request_ratio = 0.001;
+    options.nearby_request_ratio = 0.1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const string_view option = argv[i];
+        const string value = argv[i + 1];
+        if (option == "--seed") {
+            options.seed = stoul(value);
+        } else if (option == "--stops") {
+            options.stop_count = stoul(value);
+        } else if (option == "--buses") {
+            options.bus_count = stoul(value);
+        } else if (option == "--stat-requests") {
+            options.stat_request_count = stoul(value);
+        } else if (option == "--route-ratio") {
+            options.route_request_ratio = stod(value);
+        } else if (option == "--nearby-ratio") {
+            options.nearby_request_ratio = stod(value);
+        } else {
+            cerr << "Unknown option: " << option << "\n";
+            return 1;
+        }
+    }
+
+    const bench::City city = bench::GenerateCity(options);
+    cout << "stops: " << options.stop_count << ", buses: " << options.bus_count << "\n";
+
+    malloc_trim(0);
+    const size_t heap_before = HeapInUse();
+    auto catalogue = make_unique<TransportCatalogue>();
+    {
+        vector<string_view> lines(city.base_requests.begin(), city.base_requests.end());
+        input::Reader reader;
+        reader.ParseLines(lines, 1);
+        reader.ApplyCommands(*catalogue, 1);
+    }
+    const size_t full_bytes = HeapInUse() - heap_before;
+
+    const size_t heap_full = HeapInUse();
+    const auto start = chrono::steady_clock::now();
+    auto compact = make_unique<CompactCatalogue>(*catalogue);
+    const double convert_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    const size_t compact_bytes = HeapInUse() - heap_full;
+
+    cout << "heap in use: full " << fixed << setprecision(1) << MiB(full_bytes) << " MiB, compact "
+         << MiB(compact_bytes) << " MiB (" << setprecision(0) << 100.0 * compact_bytes / full_bytes << "%), "
+         << setprecision(1) << static_cast<double>(full_bytes) / options.stop_count << " -> "
+         << static_cast<double>(compact_bytes) / options.stop_count << " bytes per stop, conversion " << convert_ms
+         << " ms\n"
+         << defaultfloat << setprecision(6);
+
+    // Точность: координаты, остановки маршрутов, расстояния перегонов, статистика маршрутов
+    double max_coordinate_error = 0;
+    for (StopId stop = 0; stop < catalogue->StopCount(); ++stop) {
+        const Coordinates exact = catalogue->GetStopCoordinates(stop);
+        const Coordinates stored = compact->GetStopCoordinates(stop);
+        max_coordinate_error = max({max_coordinate_error, abs(exact.lat - stored.lat), abs(exact.lng - stored.lng)});
+    }
+    size_t route_mismatches = 0;
+    size_t distance_mismatches = 0;
+    size_t stats_mismatches = 0;
+    size_t segments = 0;
+    for (BusId bus = 0; bus < catalogue->BusCount(); ++bus) {
+        const auto exact = catalogue->GetBusStops(bus);
+        const auto decoded = compact->GetBusStops(bus);
+        const vector<StopId> stored(decoded.begin(), decoded.end());
+        route_mismatches += !equal(exact.begin(), exact.end(), stored.begin(), stored.end());
+        for (size_t i = 0; i + 1 < exact.size(); ++i, ++segments) {
+            distance_mismatches +=
+                catalogue->GetDistance(exact[i], exact[i + 1]) != compact->GetDistance(exact[i], exact[i + 1]);
+        }
+        const RouteInfo exact_info = catalogue->GetRouteInfo(bus);
+        const RouteInfo stored_info = compact->GetRouteInfo(bus);
+        stats_mismatches += exact_info.stops_count != stored_info.stops_count
+                            || exact_info.unique_stops_count != stored_info.unique_stops_count
+                            || exact_info.route_length != stored_info.route_length
+                            || exact_info.curvature != stored_info.curvature;
+    }
+    cout << "city coordinates: max error " << max_coordinate_error << " degrees\n"
+         << "bus routes differing: " << route_mismatches << ", segment distances differing: " << distance_mismatches
+         << " of " << segments << ", route stats differing: " << stats_mismatches << "\n";
+    CheckCoordinatePrecision(200'000);
+
+    // Ответы на запросы к базе через оба справочника
+    {
+        const router::TransportRouter full_router(*catalogue, router::RoutingSettings{});
+        const router::TransportRouter compact_router(*compact, router::RoutingSettings{});
+        const SpatialIndex full_index(*catalogue);
+        const SpatialIndex compact_index(*compact);
+        output::Writer full_output;
+        output::Writer compact_output;
+        size_t answer_mismatches = 0;
+        for (const string& request : city.stat_requests) {
+            stat_p::ParseAndPrintStat(*catalogue, request, full_output, &full_router, &full_index);
+            stat_p::ParseAndPrintStat(*compact, request, compact_output, &compact_router, &compact_index);
+            answer_mismatches += full_output.View() != compact_output.View();
+            full_output.Clear();
+            compact_output.Clear();
+        }
+        cout << "stat answers differing: " << answer_mismatches << " of " << city.stat_requests.size() << "\n";
+    }
+
+    // Задержки: одни и те же обращения к обоим справочникам
+    vector<string_view> bus_names;
+    vector<StopId> stops;
+    vector<pair<StopId, StopId>> pairs;
+    mt19937 random(options.seed);
+    for (size_t i = 0; i < 100'000 && options.bus_count > 0; ++i) {
+        const BusId bus = static_cast<BusId>(random() % options.bus_count);
+        bus_names.push_back(catalogue->GetBusName(bus));
+        const auto route = catalogue->GetBusStops(bus);
+        stops.push_back(route[random() % route.size()]);
+        const size_t segment = random() % route.size();
+        pairs.emplace_back(route[segment], route[(segment + 1) % route.size()]);
+    }
+    size_t checksum = 0;
+    cout << "latency per call:        full   compact\n";
+    auto measure_both = [&](string_view name, auto func) {
+        const double full = MeasurePerCall(bus_names.size(), [&] { func(static_cast<const CatalogueView&>(*catalogue)); });
+        const double packed = MeasurePerCall(bus_names.size(), [&] { func(static_cast<const CatalogueView&>(*compact)); });
+        ReportLatency(name, full, packed);
+    };
+    measure_both("RouteInformation", [&](const CatalogueView& view) {
+        for (string_view name : bus_names) {
+            checksum += view.RouteInformation(name).stops_count;
+        }
+    });
+    measure_both("GetBusesForStop", [&](const CatalogueView& view) {
+        for (StopId stop : stops) {
+            checksum += view.GetBusesForStop(stop).size();
+        }
+    });
+    measure_both("GetDistance", [&](const CatalogueView& view) {
+        for (const auto& [from, to] : pairs) {
+            checksum += view.GetDistance(from, to);
+        }
+    });
+    measure_both("GetBusStops", [&](const CatalogueView& view) {
+        for (const auto& [from, to] : pairs) {
+            const auto buses = view.GetBusesForStop(from);
+            if (!buses.empty()) {
+                checksum += view.GetBusStops(buses.front()).size();
+            }
+        }
+    });
+    measure_both("GetStopCoordinates", [&](const CatalogueView& view) {
+        double sum = 0;
+        for (StopId stop : stops) {
+            sum += view.GetStopCoordinates(stop).lat;
+        }
+        checksum += static_cast<size_t>(sum);
+    });
+    cout << "checksum: " << checksum << "\n";
+    return 0;
+}
@@ -0,0 +1,190 @@
+// Табло отправлений на синтетическом городе с расписаниями-интервалами:
+// построение (время, число отправлений, память), задержка запроса по табло
+// против пересчёта прохождений рейсов на каждый запрос, совпадение ответов
+// и полный путь запроса Departures через ParseAndPrintStat
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../departure_board.h"
+#include "../input_reader.h"
+#include "../output_writer.h"
+#include "../stat_reader.h"
+#include "../transport_catalogue.h"
+#include "city_generator.h"
+
+using namespace std;
+using namespace transport_catalogue;
+
+namespace {
+
+constexpr double kBusVelocity = 40;
+
+// Те же отправления, что у DepartureBoard, но посчитанные заново по маршрутам автобусов остановки
+void RecomputeDepartures(const CatalogueView& catalogue, const vector<vector<uint32_t>>& trips, StopId stop,
+                         uint32_t time, size_t count, vector<Departure>& result) {
+    const double meters_per_minute = kBusVelocity * 1000 / 60;
+    result.clear();
+    for (const BusId bus : catalogue.GetBusesForStop(stop)) {
+        if (trips[bus].empty()) {
+            continue;
+        }
+        const auto route = catalogue.GetBusStops(bus);
+        double offset = 0;
+        for (size_t i = 0; i + 1 < route.size(); ++i) {
+            if (route[i] == stop) {
+                for (const uint32_t departure : trips[bus]) {
+                    const auto at = static_cast<uint32_t>(lround(departure + offset));
+                    if (at >= time) {
+                        result.push_back({at, bus});
+                    }
+                }
+            }
+            offset += catalogue.GetSegmentLength(route[i], route[i + 1]) / meters_per_minute;
+        }
+    }
+    stable_sort(result.begin(), result.end(), [](const Departure& lhs, const Departure& rhs) {
+        return lhs.time < rhs.time;
+    });
+    result.resize(min(result.size(), count));
+}
+
+// Лучшее из нескольких повторов время на запрос, наносекунды
+template <typename Func>
+double MeasurePerQuery(size_t queries, Func func) {
+    constexpr int kRepeats = 3;
+    double best = 1e300;
+    for (int i = 0; i < kRepeats; ++i) {
+        const auto start = chrono::steady_clock::now();
+        func();
+        best = min(best, chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+    }
+    return best / static_cast<double>(max<size_t>(queries, 1));
+}
+
+string ClockTime(uint32_t minutes) {
+    string text = to_string(minutes / 60) + ":" + (minutes % 60 < 10 ? "0" : "") + to_string(minutes % 60);
+    return minutes < 600 ? "0" + text : text;
+}
+
+} // namespace
+
+/**
+ * Параметры (все необязательные):
+ *   --seed N --stops N --buses N --queries N --count N
+ */
+int main(int argc, char* argv[]) {
+    bench::CityOptions options;
+    options.stop_count = 20'000;
+    options.bus_count = 2'000;
+    options.stat_request_count = 0;
+    size_t query_count = 100'000;
+    size_t departure_count = stat_p::DeparturesRequest::kDefaultCount;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const string_view option = argv[i];
+        const string value = argv[i + 1];
+        if (option == "--seed") {
+            options.seed = stoul(value);
+        } else if (option == "--stops") {
+            options.stop_count = stoul(value);
+        } else if (option == "--buses") {
+            options.bus_count = stoul(value);
+        } else if (option == "--queries") {
+            query_count = stoul(value);
+        } else if (option == "--count") {
+            departure_count = stoul(value);
+        } else {
+            cerr << "Unknown option: " << option << "\n";
+            return 1;
+        }
+    }
+
+    // Каждый маршрут ходит с 05:00 до полуночи с интервалом 5-30 минут
+    bench::City city = bench::GenerateCity(options);
+    mt19937 random(options.seed);
+    for (size_t bus = 0; bus < options.bus_count; ++bus) {
+        city.base_requests.push_back("Timetable " + to_string(bus + 1) + ": 05:00 to 24:00 every "
+                                     + to_string(5 + random() % 26));
+    }
+
+    TransportCatalogue catalogue;
+    vector<TripSchedule> schedules;
+    {
+        vector<string_view> lines(city.base_requests.begin(), city.base_requests.end());
+        input::Reader reader;
+        reader.ParseLines(lines, 1);
+        reader.ApplyCommands(catalogue, 1);
+        schedules = reader.TakeSchedules();
+    }
+
+    size_t trip_count = 0;
+    vector<vector<uint32_t>> trips(catalogue.BusCount());
+    for (const TripSchedule& schedule : schedules) {
+        if (const auto bus = catalogue.GetBus(schedule.bus)) {
+            trips[*bus] = schedule.departures;
+            trip_count += schedule.departures.size();
+        }
+    }
+
+    const auto start = chrono::steady_clock::now();
+    const DepartureBoard board(catalogue, schedules, kBusVelocity);
+    const double build_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "stops: " << catalogue.StopCount() << ", buses: " << catalogue.BusCount() << ", trips: " << trip_count
+         << ", departures: " << board.DepartureCount() << "\n"
+         << "board: " << fixed << setprecision(1) << build_ms << " ms to build, "
+         << board.DepartureCount() * sizeof(Departure) / 1024.0 / 1024.0 << " MiB\n"
+         << defaultfloat << setprecision(6);
+
+    // Запросы к случайным остановкам на случайное время суток
+    vector<pair<StopId, uint32_t>> queries;
+    vector<string> texts;
+    for (size_t i = 0; i < query_count; ++i) {
+        const auto stop = static_cast<StopId>(random() % catalogue.StopCount());
+        const auto time = static_cast<uint32_t>(random() % (24 * 60));
+        queries.emplace_back(stop, time);
+        texts.push_back("Departures " + string(catalogue.GetStopName(stop)) + " at " + ClockTime(time) + ", "
+                        + to_string(departure_count));
+    }
+
+    size_t mismatches = 0;
+    vector<Departure> expected;
+    for (const auto& [stop, time] : queries) {
+        RecomputeDepartures(catalogue, trips, stop, time, departure_count, expected);
+        const auto found = board.FindDepartures(stop, time, departure_count);
+        mismatches += !equal(found.begin(), found.end(), expected.begin(), expected.end(),
+                             [](const Departure& lhs, const Departure& rhs) {
+                                 return lhs.time == rhs.time && lhs.bus == rhs.bus;
+                             });
+    }
+    cout << "queries: " << queries.size() << ", differing from recomputation: " << mismatches << "\n";
+
+    size_t checksum = 0;
+    const double board_ns = MeasurePerQuery(queries.size(), [&] {
+        for (const auto& [stop, time] : queries) {
+            checksum += board.FindDepartures(stop, time, departure_count).size();
+        }
+    });
+    const double recompute_ns = MeasurePerQuery(queries.size(), [&] {
+        for (const auto& [stop, time] : queries) {
+            RecomputeDepartures(catalogue, trips, stop, time, departure_count, expected);
+            checksum += expected.size();
+        }
+    });
+    output::Writer output;
+    const double request_ns = MeasurePerQuery(texts.size(), [&] {
+        for (const string& text : texts) {
+            stat_p::ParseAndPrintStat(catalogue, text, output, nullptr, nullptr, &board);
+            output.Clear();
+        }
+    });
+    cout << fixed << setprecision(1) << "latency per query: board " << board_ns << " ns, recomputation "
+         << recompute_ns << " ns, Departures request " << request_ns << " ns\n"
+         << defaultfloat << "checksum: " << checksum << "\n";
+    return 0;
+}
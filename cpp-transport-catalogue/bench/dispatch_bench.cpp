@@ -0,0 +1,178 @@
+// Стоимость разбора и диспетчеризации запросов к базе на синтетическом городе:
+// поиск команды сравнением строк и по таблице команд (в том числе таблице,
+// где команд вчетверо больше), разбор в StatRequest, выполнение уже
+// разобранного запроса и полный путь ParseAndPrintStat
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../command_table.h"
+#include "../input_reader.h"
+#include "../output_writer.h"
+#include "../spatial_index.h"
+#include "../stat_reader.h"
+#include "../transport_catalogue.h"
+#include "../transport_router.h"
+#include "city_generator.h"
+
+using namespace std;
+using namespace transport_catalogue;
+
+namespace {
+
+// Поиск команды цепочкой сравнений, как до таблицы команд
+size_t FindByComparison(string_view command) {
+    if (command == "Bus") {
+        return 0;
+    }
+    if (command == "Stop") {
+        return 1;
+    }
+    if (command == "Route") {
+        return 2;
+    }
+    if (command == "Nearby") {
+        return 3;
+    }
+    if (command == "Nearest") {
+        return 4;
+    }
+    return 5;
+}
+
+// Те же команды в окружении пятнадцати других: поиск не должен стать дороже
+constexpr dispatch::CommandTable<20> kWideTable({"Bus", "Stop", "Route", "Nearby", "Nearest", "Map", "Depot",
+                                                 "Timetable", "Departures", "Transfer", "Zone", "Fare", "Line",
+                                                 "Platform", "Exit", "Entrance", "Ticket", "Schedule", "Alert",
+                                                 "Vehicle"});
+
+// Лучшее из нескольких повторов время на строку, наносекунды
+double MeasurePerLine(size_t lines, const function<void()>& pass) {
+    constexpr int kRepeats = 5;
+    double best = 1e300;
+    for (int i = 0; i < kRepeats; ++i) {
+        const auto start = chrono::steady_clock::now();
+        pass();
+        best = min(best, chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+    }
+    return best / static_cast<double>(lines);
+}
+
+void Report(string_view name, double nanoseconds) {
+    cout << "  " << left << setw(34) << name << right << fixed << setprecision(2) << setw(10) << nanoseconds
+         << " ns/request\n"
+         << defaultfloat;
+}
+
+} // namespace
+
+/**
+ * Параметры (все необязательные):
+ *   --seed N --stops N --buses N --stat-requests N --route-ratio X --nearby-ratio X
+ */
+int main(int argc, char* argv[]) {
+    bench::CityOptions options;
+    options.stop_count = 20'000;
+    options.bus_count = 2'000;
+    options.stat_request_count = 200'000;
+    // Route без предварительного расчёта на порядки дороже разбора и заслонил бы его
+    options.route_request_ratio = 0;
+    options.nearby_request_ratio = 0.1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const string_view option = argv[i];
+        const string value = argv[i + 1];
+        if (option == "--seed") {
+            options.seed = stoul(value);
+        } else if (option == "--stops") {
+            options.stop_count = stoul(value);
+        } else if (option == "--buses") {
+            options.bus_count = stoul(value);
+        } else if (option == "--stat-requests") {
+            options.stat_request_count = stoul(value);
+        } else if (option == "--route-ratio") {
+            options.route_request_ratio = stod(value);
+        } else if (option == "--nearby-ratio") {
+            options.nearby_request_ratio = stod(value);
+        } else {
+            cerr << "Unknown option: " << option << "\n";
+            return 1;
+        }
+    }
+
+    const bench::City city = bench::GenerateCity(options);
+    TransportCatalogue catalogue;
+    {
+        vector<string_view> lines(city.base_requests.begin(), city.base_requests.end());
+        input::Reader reader;
+        reader.ParseLines(lines, 1);
+        reader.ApplyCommands(catalogue, 1);
+    }
+    const router::TransportRouter transport_router(catalogue, router::RoutingSettings{});
+    const SpatialIndex spatial_index(catalogue);
+
+    // Каждый десятый Nearby превращается в Nearest, чтобы в смеси были все команды
+    vector<string> texts(city.stat_requests.begin(), city.stat_requests.end());
+    for (size_t i = 0; i < texts.size(); i += 10) {
+        if (texts[i].starts_with("Nearby ")) {
+            texts[i] = "Nearest " + texts[i].substr(7, texts[i].rfind(',') - 7);
+        }
+    }
+    const vector<string_view> requests(texts.begin(), texts.end());
+    vector<string_view> commands;
+    commands.reserve(requests.size());
+    for (string_view request : requests) {
+        commands.push_back(request.substr(0, request.find(' ')));
+    }
+
+    cout << "stops: " << options.stop_count << ", buses: " << options.bus_count << ", requests: " << requests.size()
+         << "\n";
+
+    size_t checksum = 0;
+    cout << "command lookup:\n";
+    Report("string comparisons", MeasurePerLine(commands.size(), [&] {
+        for (string_view command : commands) {
+            checksum += FindByComparison(command);
+        }
+    }));
+    Report("command table, 5 commands", MeasurePerLine(commands.size(), [&] {
+        for (string_view command : commands) {
+            checksum += stat_p::StatCommands::Find(command);
+        }
+    }));
+    Report("command table, 20 commands", MeasurePerLine(commands.size(), [&] {
+        for (string_view command : commands) {
+            checksum += kWideTable.Find(command);
+        }
+    }));
+
+    cout << "parse and execute:\n";
+    vector<stat_p::StatRequest> parsed(requests.size());
+    Report("ParseStatRequest", MeasurePerLine(requests.size(), [&] {
+        for (size_t i = 0; i < requests.size(); ++i) {
+            parsed[i] = stat_p::ParseStatRequest(requests[i]);
+        }
+    }));
+    checksum += count_if(parsed.begin(), parsed.end(), [](const auto& request) { return request.index() == 0; });
+
+    output::Writer output;
+    Report("ExecuteStatRequest, parsed once", MeasurePerLine(requests.size(), [&] {
+        for (const auto& request : parsed) {
+            stat_p::ExecuteStatRequest(catalogue, request, output, &transport_router, &spatial_index);
+            output.Clear();
+        }
+    }));
+    Report("ParseAndPrintStat", MeasurePerLine(requests.size(), [&] {
+        for (string_view request : requests) {
+            stat_p::ParseAndPrintStat(catalogue, request, output, &transport_router, &spatial_index);
+            output.Clear();
+        }
+    }));
+
+    cout << "checksum: " << checksum << "\n";
+    return 0;
+}
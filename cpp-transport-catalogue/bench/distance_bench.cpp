@@ -0,0 +1,120 @@
+// Сравнение скорости GetDistance на CSR-индексе с прежней хеш-таблицей
+// std::unordered_map<std::pair<const Stop*, const Stop*>, int, PairHasher>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../transport_catalogue.h"
+
+using namespace std;
+using namespace transport_catalogue;
+
+namespace {
+
+// Прежняя схема хранения расстояний
+struct Stop {
+    std::string name;
+    Coordinates coordinates;
+};
+
+struct PairHasher {
+    size_t operator()(const std::pair<const Stop*, const Stop*> pr) const {
+        auto h1 = std::hash<const Stop*>{}(pr.first);
+        auto h2 = std::hash<const Stop*>{}(pr.second);
+        return h1 + h2 * 37;
+    }
+};
+
+using PointerDistances = std::unordered_map<std::pair<const Stop*, const Stop*>, int, PairHasher>;
+
+int GetDistanceOld(const PointerDistances& distances, const Stop* from, const Stop* to) {
+    if (distances.count({from, to})) {
+        return distances.at({from, to});
+    }
+    if (distances.count({to, from})) {
+        return distances.at({to, from});
+    }
+    return 0;
+}
+
+template <typename Func>
+double MeasureSeconds(Func func) {
+    const auto start = chrono::steady_clock::now();
+    func();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t stop_count = argc > 1 ? stoul(argv[1]) : 200'000;
+    const size_t distance_count = argc > 2 ? stoul(argv[2]) : 1'200'000;
+    const size_t lookup_count = argc > 3 ? stoul(argv[3]) : 10'000'000;
+
+    mt19937 random(42);
+    uniform_int_distribution<StopId> random_stop(0, static_cast<StopId>(stop_count - 1));
+
+    TransportCatalogue catalogue;
+    deque<Stop> old_stops;
+    for (size_t i = 0; i < stop_count; ++i) {
+        const string name = "Stop " + to_string(i);
+        catalogue.AddStop(name, {55.0, 37.0});
+        old_stops.push_back({name, {55.0, 37.0}});
+    }
+
+    vector<pair<StopId, StopId>> edges;
+    edges.reserve(distance_count);
+    PointerDistances old_distances;
+    for (size_t i = 0; i < distance_count; ++i) {
+        const StopId from = random_stop(random);
+        const StopId to = random_stop(random);
+        const int meters = static_cast<int>(i % 10000) + 1;
+        catalogue.SetDistance(from, to, meters);
+        old_distances[{&old_stops[from], &old_stops[to]}] = meters;
+        edges.emplace_back(from, to);
+    }
+    const double build_seconds = MeasureSeconds([&] { catalogue.BuildIndexes(); });
+
+    // Половина запросов - существующие пары в обратном направлении
+    vector<pair<StopId, StopId>> queries;
+    queries.reserve(lookup_count);
+    for (size_t i = 0; i < lookup_count; ++i) {
+        const auto [from, to] = edges[random() % edges.size()];
+        if (i % 2 == 0) {
+            queries.emplace_back(from, to);
+        } else {
+            queries.emplace_back(to, from);
+        }
+    }
+
+    long long old_sum = 0;
+    const double old_seconds = MeasureSeconds([&] {
+        for (const auto& [from, to] : queries) {
+            old_sum += GetDistanceOld(old_distances, &old_stops[from], &old_stops[to]);
+        }
+    });
+
+    long long new_sum = 0;
+    const double new_seconds = MeasureSeconds([&] {
+        for (const auto& [from, to] : queries) {
+            new_sum += catalogue.GetDistance(from, to);
+        }
+    });
+
+    cout << "stops: " << stop_count << ", distances: " << distance_count
+         << ", lookups: " << lookup_count << "\n"
+         << "index build: " << build_seconds << " s\n"
+         << "pointer-pair map: " << lookup_count / old_seconds / 1e6 << " M lookups/s\n"
+         << "CSR index: " << lookup_count / new_seconds / 1e6 << " M lookups/s\n"
+         << "speedup: " << old_seconds / new_seconds << "x\n";
+
+    if (old_sum != new_sum) {
+        cerr << "checksum mismatch: " << old_sum << " != " << new_sum << "\n";
+        return 1;
+    }
+    return 0;
+}
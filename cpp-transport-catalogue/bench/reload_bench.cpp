@@ -0,0 +1,238 @@
+// Запросы к справочнику во время фоновой перезагрузки. Читатели непрерывно выполняют
+// запросы к текущей версии через parallel::Versioned, писатель в это время заново
+// собирает справочник из одного из нескольких наборов данных и публикует его.
+// Каждый ответ сверяется с эталоном той версии, которую видел читатель; задержки
+// сравниваются с прогоном без перезагрузок
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../input_reader.h"
+#include "../output_writer.h"
+#include "../spatial_index.h"
+#include "../stat_reader.h"
+#include "../transport_router.h"
+#include "../versioned.h"
+
+using namespace std;
+using namespace transport_catalogue;
+
+namespace {
+
+// Версия со всем, что нужно запросам: индексы ссылаются на справочник той же версии
+struct CatalogueState {
+    explicit CatalogueState(const vector<string>& lines) {
+        input::Reader reader;
+        reader.ParseLines(vector<string_view>(lines.begin(), lines.end()), 1);
+        reader.ApplyCommands(catalogue);
+        router = make_unique<router::TransportRouter>(catalogue, router::RoutingSettings{});
+        spatial_index = make_unique<SpatialIndex>(catalogue);
+    }
+
+    size_t dataset = 0;
+    TransportCatalogue catalogue;
+    unique_ptr<router::TransportRouter> router;
+    unique_ptr<SpatialIndex> spatial_index;
+};
+
+// Наборы различаются координатами, расстояниями и маршрутами, названия общие
+vector<string> MakeDataset(size_t stop_count, size_t bus_count, unsigned seed) {
+    mt19937 random(seed);
+    uniform_real_distribution<double> random_lat(55.5, 56.0);
+    uniform_real_distribution<double> random_lng(37.3, 37.9);
+
+    vector<vector<size_t>> routes(bus_count);
+    vector<string> lines;
+    for (size_t i = 0; i < bus_count; ++i) {
+        const size_t length = 3 + random() % 12;
+        string line = "Bus Bus " + to_string(i) + ": ";
+        for (size_t j = 0; j < length; ++j) {
+            routes[i].push_back(random() % stop_count);
+            line += (j ? " - Stop " : "Stop ") + to_string(routes[i].back());
+        }
+        lines.push_back(move(line));
+    }
+
+    vector<vector<size_t>> neighbours(stop_count);
+    for (const auto& route : routes) {
+        for (size_t j = 0; j + 1 < route.size(); ++j) {
+            neighbours[route[j]].push_back(route[j + 1]);
+            neighbours[route[j + 1]].push_back(route[j]);
+        }
+    }
+    for (size_t i = 0; i < stop_count; ++i) {
+        string line = "Stop Stop " + to_string(i) + ": " + to_string(random_lat(random)) + ", "
+                      + to_string(random_lng(random));
+        sort(neighbours[i].begin(), neighbours[i].end());
+        neighbours[i].erase(unique(neighbours[i].begin(), neighbours[i].end()), neighbours[i].end());
+        for (const size_t to : neighbours[i]) {
+            line += ", " + to_string(500 + random() % 3000) + "m to Stop " + to_string(to);
+        }
+        lines.push_back(move(line));
+    }
+    return lines;
+}
+
+vector<string> MakeRequests(size_t stop_count, size_t bus_count, size_t count) {
+    mt19937 random(7);
+    vector<string> requests;
+    for (size_t i = 0; i < count; ++i) {
+        switch (i % 4) {
+            case 0:
+                requests.push_back("Bus Bus " + to_string(random() % bus_count));
+                break;
+            case 1:
+                requests.push_back("Stop Stop " + to_string(random() % stop_count));
+                break;
+            case 2:
+                requests.push_back("Route Stop " + to_string(random() % stop_count) + " to Stop "
+                                   + to_string(random() % stop_count));
+                break;
+            default:
+                requests.push_back("Nearest 55." + to_string(500 + random() % 500) + ", 37."
+                                   + to_string(300 + random() % 600));
+        }
+    }
+    return requests;
+}
+
+string Answer(const CatalogueState& state, string_view request) {
+    output::Writer output;
+    stat_p::ParseAndPrintStat(state.catalogue, request, output, state.router.get(), state.spatial_index.get());
+    return string(output.View());
+}
+
+struct ReaderResult {
+    vector<double> latencies;   // наносекунды
+    size_t mismatches = 0;
+    uint64_t versions_seen = 0;
+};
+
+// Читатели выполняют запросы, пока не будет выставлен stop
+vector<ReaderResult> RunReaders(const parallel::Versioned<CatalogueState>& versions, const vector<string>& requests,
+                                const vector<vector<string>>& expected, size_t reader_count,
+                                const atomic<bool>& stop, const function<void()>& during) {
+    vector<ReaderResult> results(reader_count);
+    vector<thread> readers;
+    for (size_t r = 0; r < reader_count; ++r) {
+        readers.emplace_back([&, r] {
+            ReaderResult& result = results[r];
+            output::Writer output;
+            uint64_t last_version = 0;
+            for (size_t i = r; !stop.load(memory_order_relaxed); i = (i + 1) % requests.size()) {
+                const auto start = chrono::steady_clock::now();
+                const auto state = versions.Read();
+                output.Clear();
+                stat_p::ParseAndPrintStat(state->catalogue, requests[i], output, state->router.get(),
+                                          state->spatial_index.get());
+                result.latencies.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+                result.mismatches += output.View() != expected[state->dataset][i];
+                if (state.Version() != last_version) {
+                    last_version = state.Version();
+                    ++result.versions_seen;
+                }
+            }
+        });
+    }
+    during();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    return results;
+}
+
+void PrintLatencies(string_view title, const vector<ReaderResult>& results) {
+    vector<double> latencies;
+    for (const auto& result : results) {
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+    }
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies.empty() ? 0.0 : latencies[min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))];
+    };
+    cout << title << ": " << latencies.size() << " queries, p50 " << percentile(0.5) / 1e3 << " us, p99 "
+         << percentile(0.99) / 1e3 << " us, p99.9 " << percentile(0.999) / 1e3 << " us, max "
+         << (latencies.empty() ? 0.0 : latencies.back() / 1e3) << " us\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t stop_count = argc > 1 ? stoul(argv[1]) : 5'000;
+    const size_t bus_count = argc > 2 ? stoul(argv[2]) : 1'000;
+    const size_t reader_count = argc > 3 ? stoul(argv[3]) : max(2u, thread::hardware_concurrency());
+    const double seconds = argc > 4 ? stod(argv[4]) : 3;
+    constexpr size_t kDatasetCount = 3;
+
+    vector<vector<string>> datasets;
+    for (size_t i = 0; i < kDatasetCount; ++i) {
+        datasets.push_back(MakeDataset(stop_count, bus_count, 100 + i));
+    }
+    const vector<string> requests = MakeRequests(stop_count, bus_count, 1000);
+
+    // Эталонные ответы каждой версии
+    vector<vector<string>> expected(kDatasetCount);
+    for (size_t i = 0; i < kDatasetCount; ++i) {
+        const CatalogueState state(datasets[i]);
+        for (const auto& request : requests) {
+            expected[i].push_back(Answer(state, request));
+        }
+    }
+
+    parallel::Versioned<CatalogueState> versions(make_unique<CatalogueState>(datasets[0]));
+    auto sleep = [seconds] { this_thread::sleep_for(chrono::duration<double>(seconds)); };
+
+    atomic<bool> stop = false;
+    const auto quiet = RunReaders(versions, requests, expected, reader_count, stop, [&] {
+        sleep();
+        stop = true;
+    });
+
+    // Писатель перестраивает справочник и публикует его, пока читатели работают
+    stop = false;
+    size_t reloads = 0;
+    double reload_seconds = 0;
+    size_t max_pending = 0;
+    const auto reloading = RunReaders(versions, requests, expected, reader_count, stop, [&] {
+        const auto finish = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+        while (chrono::steady_clock::now() < finish) {
+            const auto start = chrono::steady_clock::now();
+            const size_t dataset = (reloads + 1) % kDatasetCount;
+            auto next = make_unique<CatalogueState>(datasets[dataset]);
+            next->dataset = dataset;
+            versions.Publish(move(next));
+            max_pending = max(max_pending, versions.Reclaim());
+            reload_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            ++reloads;
+        }
+        stop = true;
+    });
+    const size_t pending = versions.Reclaim();
+
+    size_t mismatches = 0;
+    uint64_t versions_seen = 0;
+    for (const auto& result : reloading) {
+        mismatches += result.mismatches;
+        versions_seen += result.versions_seen;
+    }
+    for (const auto& result : quiet) {
+        mismatches += result.mismatches;
+    }
+
+    cout << "stops: " << stop_count << ", buses: " << bus_count << ", readers: " << reader_count << "\n";
+    PrintLatencies("without reloads", quiet);
+    PrintLatencies("during reloads", reloading);
+    cout << "reloads: " << reloads << ", " << reload_seconds / max<size_t>(reloads, 1) * 1e3 << " ms each\n"
+         << "version switches seen by readers: " << versions_seen << "\n"
+         << "retired versions not yet freed: " << max_pending << " at most, " << pending << " at the end\n"
+         << "mismatched answers: " << mismatches << "\n";
+
+    return mismatches == 0 && pending == 0 ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+// Сравнение запросов Route: Дейкстра, таблица всех пар и иерархия сжатий.
+// Ответы предварительно рассчитанных способов должны совпадать с Дейкстрой:
+// другой маршрут того же времени тоже считается расхождением
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../transport_catalogue.h"
+#include "../transport_router.h"
+
+using namespace std;
+using namespace transport_catalogue;
+using router::PrecomputeMode;
+using router::RouteResult;
+using router::TransportRouter;
+
+namespace {
+
+template <typename Func>
+double MeasureSeconds(Func func) {
+    const auto start = chrono::steady_clock::now();
+    func();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+enum class Match {
+    kSame,          // тот же путь
+    kEqualTime,     // другой путь того же времени с точностью до округления суммы
+    kDifferent,
+};
+
+Match CompareRoutes(const optional<RouteResult>& expected, const optional<RouteResult>& actual) {
+    if (expected.has_value() != actual.has_value()) {
+        return Match::kDifferent;
+    }
+    if (!expected) {
+        return Match::kSame;
+    }
+    bool same_items = expected->items.size() == actual->items.size();
+    for (size_t i = 0; same_items && i < expected->items.size(); ++i) {
+        const auto& l = expected->items[i];
+        const auto& r = actual->items[i];
+        same_items = l.is_wait == r.is_wait && l.stop == r.stop && l.bus == r.bus && l.span_count == r.span_count;
+    }
+    if (same_items && expected->total_time == actual->total_time) {
+        return Match::kSame;
+    }
+    return abs(expected->total_time - actual->total_time) <= 1e-9 * expected->total_time ? Match::kEqualTime
+                                                                                          : Match::kDifferent;
+}
+
+const char* ModeName(PrecomputeMode mode) {
+    switch (mode) {
+    case PrecomputeMode::kAllPairs:
+        return "all-pairs table";
+    case PrecomputeMode::kContraction:
+        return "contraction hierarchy";
+    default:
+        return "dijkstra";
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t stop_count = argc > 1 ? stoul(argv[1]) : 2'000;
+    const size_t bus_count = argc > 2 ? stoul(argv[2]) : stop_count / 10;
+    const size_t query_count = argc > 3 ? stoul(argv[3]) : 20'000;
+
+    // Остановки на квадратной сетке, маршруты - случайные блуждания по соседним узлам
+    mt19937 random(42);
+    const size_t side = static_cast<size_t>(ceil(sqrt(static_cast<double>(stop_count))));
+    TransportCatalogue catalogue;
+    for (size_t i = 0; i < stop_count; ++i) {
+        catalogue.AddStop("Stop " + to_string(i), {55.0 + (i / side) * 0.003, 37.0 + (i % side) * 0.005});
+    }
+
+    uniform_int_distribution<size_t> random_stop(0, stop_count - 1);
+    uniform_int_distribution<size_t> random_length(5, 25);
+    for (size_t bus = 0; bus < bus_count; ++bus) {
+        vector<StopId> stops{static_cast<StopId>(random_stop(random))};
+        const size_t length = random_length(random);
+        while (stops.size() < length) {
+            const size_t current = stops.back();
+            const size_t candidates[] = {current + 1, current - 1, current + side, current - side};
+            const size_t next = candidates[random() % 4];
+            if (next < stop_count) {
+                catalogue.SetDistance(static_cast<StopId>(current), static_cast<StopId>(next),
+                                      300 + static_cast<int>(random() % 700));
+                stops.push_back(static_cast<StopId>(next));
+            }
+        }
+        const bool roundtrip = bus % 3 == 0;
+        if (roundtrip) {
+            stops.push_back(stops.front());
+        } else {
+            stops.insert(stops.end(), stops.rbegin() + 1, stops.rend());
+        }
+        catalogue.AddBus("Bus " + to_string(bus), span<const StopId>(stops), roundtrip);
+    }
+    catalogue.BuildIndexes();
+
+    TransportRouter transport_router(catalogue, {});
+    cout << "stops: " << stop_count << ", buses: " << bus_count << ", edges: " << transport_router.EdgeCount()
+         << ", queries: " << query_count << "\n";
+
+    vector<pair<StopId, StopId>> queries;
+    queries.reserve(query_count);
+    for (size_t i = 0; i < query_count; ++i) {
+        queries.emplace_back(static_cast<StopId>(random_stop(random)), static_cast<StopId>(random_stop(random)));
+    }
+
+    vector<optional<RouteResult>> expected(query_count);
+    const double dijkstra_seconds = MeasureSeconds([&] {
+        for (size_t i = 0; i < query_count; ++i) {
+            expected[i] = transport_router.BuildRouteDijkstra(queries[i].first, queries[i].second);
+        }
+    });
+    cout << ModeName(PrecomputeMode::kNone) << ": " << dijkstra_seconds / query_count * 1e6 << " us/query\n";
+
+    int mismatches = 0;
+    for (PrecomputeMode mode : {PrecomputeMode::kAllPairs, PrecomputeMode::kContraction}) {
+        if (mode == PrecomputeMode::kAllPairs && stop_count > 4 * TransportRouter::kAllPairsMaxStops) {
+            continue;
+        }
+        transport_router.Precompute(mode);
+        const auto& stats = transport_router.GetPrecomputeStats();
+
+        vector<optional<RouteResult>> actual(query_count);
+        const double seconds = MeasureSeconds([&] {
+            for (size_t i = 0; i < query_count; ++i) {
+                actual[i] = transport_router.BuildRoute(queries[i].first, queries[i].second);
+            }
+        });
+
+        int equal_time = 0;
+        int mode_mismatches = 0;
+        for (size_t i = 0; i < query_count; ++i) {
+            const Match match = CompareRoutes(expected[i], actual[i]);
+            equal_time += match == Match::kEqualTime;
+            mode_mismatches += match != Match::kSame;
+        }
+        mismatches += mode_mismatches;
+
+        cout << ModeName(mode) << ": build " << stats.build_seconds << " s, memory "
+             << stats.memory_bytes / 1048576.0 << " MiB, " << seconds / query_count * 1e6 << " us/query, "
+             << "speedup " << dijkstra_seconds / seconds << "x, "
+             << "other route of equal time " << equal_time << ", mismatches " << mode_mismatches << "\n";
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
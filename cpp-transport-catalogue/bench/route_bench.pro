@@ -0,0 +1,20 @@
+CONFIG += c++20 cmdline
+CONFIG -= qt
+CONFIG += thread
+QMAKE_CXXFLAGS += -ffp-contract=off
+
+SOURCES += \
+    route_bench.cpp \
+    ../contraction_hierarchy.cpp \
+    ../geo.cpp \
+    ../name_interner.cpp \
+    ../transport_catalogue.cpp \
+    ../transport_router.cpp
+
+HEADERS += \
+    ../contraction_hierarchy.h \
+    ../geo.h \
+    ../name_interner.h \
+    ../parallel.h \
+    ../transport_catalogue.h \
+    ../transport_router.h
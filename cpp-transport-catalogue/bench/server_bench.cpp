@@ -0,0 +1,176 @@
+// Пропускная способность сервера запросов при разной глубине конвейера:
+// клиент отправляет depth запросов одной записью и ждёт все ответы.
+// Ответы сверяются с прямым вызовом ParseAndPrintStat
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../output_writer.h"
+#include "../server.h"
+#include "../stat_reader.h"
+#include "../transport_catalogue.h"
+
+using namespace std;
+using namespace transport_catalogue;
+
+namespace {
+
+int Connect(const string& address) {
+    if (address.starts_with("unix:")) {
+        sockaddr_un socket_address{};
+        socket_address.sun_family = AF_UNIX;
+        address.copy(socket_address.sun_path, sizeof(socket_address.sun_path) - 1, 5);
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        connect(fd, reinterpret_cast<sockaddr*>(&socket_address), sizeof(socket_address));
+        return fd;
+    }
+    const auto colon = address.rfind(':');
+    sockaddr_in socket_address{};
+    socket_address.sin_family = AF_INET;
+    socket_address.sin_port = htons(static_cast<uint16_t>(stoi(address.substr(colon + 1))));
+    inet_pton(AF_INET, address.substr(0, colon).c_str(), &socket_address.sin_addr);
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    connect(fd, reinterpret_cast<sockaddr*>(&socket_address), sizeof(socket_address));
+    return fd;
+}
+
+struct ClientResult {
+    size_t answered = 0;
+    size_t mismatches = 0;
+};
+
+// Отправляет запросы пачками по depth и сравнивает полученный поток ответов с ожидаемым
+ClientResult RunClient(const string& address, const vector<string>& requests, const vector<string>& expected,
+                       size_t depth, size_t total) {
+    ClientResult result;
+    const int fd = Connect(address);
+    string batch;
+    string expected_batch;
+    string received;
+    char chunk[64 * 1024];
+    for (size_t sent = 0; sent < total;) {
+        batch.clear();
+        expected_batch.clear();
+        size_t in_batch = 0;
+        for (; in_batch < depth && sent < total; ++in_batch, ++sent) {
+            batch += requests[sent % requests.size()];
+            batch += '\n';
+            expected_batch += expected[sent % requests.size()];
+        }
+        for (size_t offset = 0; offset < batch.size();) {
+            const ssize_t written = write(fd, batch.data() + offset, batch.size() - offset);
+            if (written <= 0) {
+                close(fd);
+                return result;
+            }
+            offset += written;
+        }
+        received.clear();
+        while (received.size() < expected_batch.size()) {
+            const ssize_t count = read(fd, chunk, sizeof(chunk));
+            if (count <= 0) {
+                close(fd);
+                return result;
+            }
+            received.append(chunk, count);
+        }
+        result.mismatches += received != expected_batch;
+        result.answered += in_batch;
+    }
+    close(fd);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t stop_count = argc > 1 ? stoul(argv[1]) : 10'000;
+    const size_t bus_count = argc > 2 ? stoul(argv[2]) : 2'000;
+    const size_t client_count = argc > 3 ? stoul(argv[3]) : 4;
+    const size_t request_count = argc > 4 ? stoul(argv[4]) : 50'000;
+
+    mt19937 random(42);
+    uniform_real_distribution<double> random_lat(55.5, 56.0);
+    uniform_real_distribution<double> random_lng(37.3, 37.9);
+
+    TransportCatalogue catalogue;
+    vector<string> stop_names;
+    for (size_t i = 0; i < stop_count; ++i) {
+        stop_names.push_back("Stop " + to_string(i));
+        catalogue.AddStop(stop_names.back(), {random_lat(random), random_lng(random)});
+    }
+    for (size_t i = 0; i < bus_count; ++i) {
+        vector<string_view> stops;
+        const size_t length = 3 + random() % 20;
+        for (size_t j = 0; j < length; ++j) {
+            stops.push_back(stop_names[random() % stop_count]);
+        }
+        catalogue.AddBus("Bus " + to_string(i), stops, false);
+        for (size_t j = 0; j + 1 < stops.size(); ++j) {
+            catalogue.SetDistance(*catalogue.GetStop(stops[j]), *catalogue.GetStop(stops[j + 1]),
+                                  500 + static_cast<int>(random() % 3000));
+        }
+    }
+    catalogue.BuildIndexes();
+
+    vector<string> requests;
+    vector<string> expected;
+    for (size_t i = 0; i < 1000; ++i) {
+        requests.push_back(i % 2 ? "Bus Bus " + to_string(random() % (bus_count + 10))
+                                 : "Stop " + stop_names[random() % stop_count]);
+        output::Writer output;
+        stat_p::ParseAndPrintStat(catalogue, requests.back(), output);
+        expected.emplace_back(output.View());
+    }
+    requests.push_back("Unknown");
+    expected.push_back("Unknown request: Unknown\n");
+
+    const string socket_path = "/tmp/transport_catalogue_bench_" + to_string(getpid()) + ".sock";
+    cout << "stops: " << stop_count << ", buses: " << bus_count << ", clients: " << client_count
+         << ", requests per client: " << request_count << "\n";
+
+    size_t mismatches = 0;
+    for (const string& listen : {"unix:" + socket_path, string("127.0.0.1:0")}) {
+        server::Server server(listen, [&](string_view request, output::Writer& output) {
+            stat_p::ParseAndPrintStat(catalogue, request, output);
+        });
+        thread server_thread([&] { server.Run(); });
+
+        for (const size_t depth : {1, 16, 256}) {
+            vector<ClientResult> results(client_count);
+            const auto start = chrono::steady_clock::now();
+            vector<thread> clients;
+            for (size_t c = 0; c < client_count; ++c) {
+                clients.emplace_back([&, c] {
+                    results[c] = RunClient(server.Address(), requests, expected, depth, request_count);
+                });
+            }
+            for (auto& client : clients) {
+                client.join();
+            }
+            const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            size_t answered = 0;
+            for (const auto& result : results) {
+                answered += result.answered;
+                mismatches += result.mismatches + (result.answered < request_count);
+            }
+            cout << (listen.starts_with("unix:") ? "unix" : "tcp ") << " depth " << depth << ": "
+                 << answered / seconds / 1e3 << "k requests/s\n";
+        }
+
+        server.Stop();
+        server_thread.join();
+    }
+    cout << "mismatched batches: " << mismatches << "\n";
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+// Проверка запроса Stop без выделений памяти: после BuildIndexes поиск автобусов
+// остановки (GetBusesForStop) и весь запрос через ParseAndPrintStat в прогретый
+// буфер вывода не должны вызывать operator new. Код возврата 1, если вызывают
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../input_reader.h"
+#include "../output_writer.h"
+#include "../stat_reader.h"
+#include "../transport_catalogue.h"
+#include "city_generator.h"
+
+using namespace std;
+using namespace transport_catalogue;
+
+namespace {
+
+atomic<size_t> allocation_count = 0;
+
+} // namespace
+
+// Подсчёт выделений памяти во всей программе, как в city_bench
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    if (void* pointer = malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+#pragma GCC diagnostic pop
+
+namespace {
+
+// Число выделений памяти за время работы func
+template <typename Func>
+size_t CountAllocations(Func func) {
+    const size_t before = allocation_count.load();
+    func();
+    return allocation_count.load() - before;
+}
+
+} // namespace
+
+/**
+ * Параметры (все необязательные):
+ *   --seed N --stops N --buses N
+ */
+int main(int argc, char* argv[]) {
+    bench::CityOptions options;
+    options.stop_count = 5'000;
+    options.bus_count = 500;
+    options.stat_request_count = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const string_view option = argv[i];
+        const string value = argv[i + 1];
+        if (option == "--seed") {
+            options.seed = stoul(value);
+        } else if (option == "--stops") {
+            options.stop_count = stoul(value);
+        } else if (option == "--buses") {
+            options.bus_count = stoul(value);
+        } else {
+            cerr << "Unknown option: " << option << "\n";
+            return 1;
+        }
+    }
+
+    // ApplyCommands заканчивается BuildIndexes
+    const bench::City city = bench::GenerateCity(options);
+    TransportCatalogue catalogue;
+    {
+        vector<string_view> lines(city.base_requests.begin(), city.base_requests.end());
+        input::Reader reader;
+        reader.ParseLines(lines, 1);
+        reader.ApplyCommands(catalogue, 1);
+    }
+
+    // Запросы ко всем остановкам и к несуществующей
+    vector<string> names;
+    vector<string> requests;
+    for (StopId stop = 0; stop < catalogue.StopCount(); ++stop) {
+        names.emplace_back(catalogue.GetStopName(stop));
+        requests.push_back("Stop " + names.back());
+    }
+    names.emplace_back("No such stop");
+    requests.push_back("Stop " + names.back());
+
+    size_t checksum = 0;
+    const size_t lookup_allocations = CountAllocations([&] {
+        for (const string& name : names) {
+            for (const BusId bus : catalogue.GetBusesForStop(name)) {
+                checksum += catalogue.GetBusName(bus).size();
+            }
+        }
+    });
+
+    // Первый проход доводит буфер вывода до размера самого длинного ответа
+    output::Writer output;
+    for (const string& request : requests) {
+        stat_p::ParseAndPrintStat(catalogue, request, output);
+        output.Clear();
+    }
+    const size_t request_allocations = CountAllocations([&] {
+        for (const string& request : requests) {
+            stat_p::ParseAndPrintStat(catalogue, request, output);
+            checksum += output.View().size();
+            output.Clear();
+        }
+    });
+
+    cout << "stops: " << catalogue.StopCount() << ", buses: " << catalogue.BusCount() << "\n"
+         << "allocations: GetBusesForStop " << lookup_allocations << ", Stop request " << request_allocations
+         << " (" << names.size() << " queries each)\n"
+         << "checksum: " << checksum << "\n";
+    if (lookup_allocations != 0 || request_allocations != 0) {
+        cout << "FAILED: Stop query allocates after BuildIndexes\n";
+        return 1;
+    }
+    return 0;
+}
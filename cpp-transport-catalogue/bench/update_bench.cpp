@@ -0,0 +1,200 @@
+// Применение пачки изменений к готовому справочнику против полной перестройки.
+// После изменений справочник сверяется с собранным заново из того же итогового набора данных
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../transport_catalogue.h"
+
+using namespace std;
+using namespace transport_catalogue;
+
+namespace {
+
+template <typename Func>
+double MeasureSeconds(Func func) {
+    const auto start = chrono::steady_clock::now();
+    func();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Итоговое состояние сети по названиям - из него собирается эталонный справочник
+struct Network {
+    map<string, Coordinates> stops;
+    map<string, pair<vector<string>, bool>> buses;
+    map<pair<string, string>, int> distances;
+};
+
+void Build(const Network& network, TransportCatalogue& catalogue) {
+    for (const auto& [name, coordinates] : network.stops) {
+        catalogue.AddStop(name, coordinates);
+    }
+    for (const auto& [name, route] : network.buses) {
+        vector<string_view> stops(route.first.begin(), route.first.end());
+        catalogue.AddBus(name, stops, route.second);
+    }
+    for (const auto& [key, meters] : network.distances) {
+        catalogue.SetDistance(*catalogue.GetStop(key.first), *catalogue.GetStop(key.second), meters);
+    }
+    catalogue.BuildIndexes();
+}
+
+// Сравнивает ответы справочников на запросы Bus и Stop по всем названиям сети
+int CountMismatches(const Network& network, const TransportCatalogue& actual, const TransportCatalogue& expected) {
+    int mismatches = 0;
+    for (const auto& [name, route] : network.buses) {
+        const RouteInfo lhs = actual.RouteInformation(name);
+        const RouteInfo rhs = expected.RouteInformation(name);
+        mismatches += lhs.stops_count != rhs.stops_count || lhs.unique_stops_count != rhs.unique_stops_count
+                      || lhs.route_length != rhs.route_length || lhs.curvature != rhs.curvature;
+    }
+    for (const auto& [name, coordinates] : network.stops) {
+        const auto lhs = actual.GetBusesForStop(name);
+        const auto rhs = expected.GetBusesForStop(name);
+        bool same = lhs.size() == rhs.size();
+        for (size_t i = 0; same && i < lhs.size(); ++i) {
+            same = actual.GetBusName(lhs[i]) == expected.GetBusName(rhs[i]);
+        }
+        mismatches += !same;
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t stop_count = argc > 1 ? stoul(argv[1]) : 100'000;
+    const size_t bus_count = argc > 2 ? stoul(argv[2]) : 20'000;
+    const size_t change_count = argc > 3 ? stoul(argv[3]) : 300;
+
+    mt19937 random(42);
+    uniform_real_distribution<double> random_lat(55.5, 56.0);
+    uniform_real_distribution<double> random_lng(37.3, 37.9);
+    auto stop_name = [](size_t i) { return "Stop " + to_string(i); };
+    auto random_stop = [&] { return stop_name(random() % stop_count); };
+
+    Network network;
+    for (size_t i = 0; i < stop_count; ++i) {
+        network.stops[stop_name(i)] = {random_lat(random), random_lng(random)};
+    }
+    auto random_route = [&] {
+        vector<string> stops;
+        const size_t length = 3 + random() % 20;
+        for (size_t i = 0; i < length; ++i) {
+            stops.push_back(random_stop());
+        }
+        return stops;
+    };
+    for (size_t i = 0; i < bus_count; ++i) {
+        auto stops = random_route();
+        const bool roundtrip = i % 2 == 0;
+        if (roundtrip) {
+            stops.push_back(stops.front());
+        }
+        for (size_t j = 0; j + 1 < stops.size(); ++j) {
+            network.distances[{stops[j], stops[j + 1]}] = 500 + static_cast<int>(random() % 3000);
+        }
+        network.buses["Bus " + to_string(i)] = {stops, roundtrip};
+    }
+
+    TransportCatalogue catalogue;
+    const double build_seconds = MeasureSeconds([&] { Build(network, catalogue); });
+
+    // Пачка изменений применяется и к справочнику, и к описанию сети
+    size_t next_stop = stop_count;
+    size_t next_bus = bus_count;
+    size_t applied = 0;
+    double update_seconds = 0;
+    for (size_t i = 0; i < change_count; ++i) {
+        const size_t kind = random() % 7;
+        if (kind == 0) {
+            const string from = random_stop();
+            const string to = random_stop();
+            const int meters = 500 + static_cast<int>(random() % 3000);
+            network.distances[{from, to}] = meters;
+            update_seconds += MeasureSeconds([&] {
+                catalogue.SetDistance(*catalogue.GetStop(from), *catalogue.GetStop(to), meters);
+            });
+        } else if (kind == 1 && !network.distances.empty()) {
+            auto it = network.distances.begin();
+            advance(it, random() % min<size_t>(network.distances.size(), 1000));
+            const auto [from, to] = it->first;
+            network.distances.erase(it);
+            update_seconds += MeasureSeconds([&] {
+                catalogue.RemoveDistance(*catalogue.GetStop(from), *catalogue.GetStop(to));
+            });
+        } else if (kind == 2) {
+            const string name = random_stop();
+            const Coordinates coordinates{random_lat(random), random_lng(random)};
+            network.stops[name] = coordinates;
+            update_seconds += MeasureSeconds([&] {
+                catalogue.SetStopCoordinates(*catalogue.GetStop(name), coordinates);
+            });
+        } else if (kind == 3) {
+            const string name = "Bus " + to_string(random() % bus_count);
+            if (!network.buses.count(name)) {
+                continue;
+            }
+            const auto stops = random_route();
+            network.buses[name] = {stops, false};
+            update_seconds += MeasureSeconds([&] {
+                vector<StopId> ids;
+                for (const auto& stop : stops) {
+                    ids.push_back(*catalogue.GetStop(stop));
+                }
+                catalogue.SetBusStops(*catalogue.GetBus(name), ids, false);
+            });
+        } else if (kind == 4) {
+            const string name = "Bus " + to_string(random() % bus_count);
+            if (!network.buses.erase(name)) {
+                continue;
+            }
+            update_seconds += MeasureSeconds([&] { catalogue.RemoveBus(*catalogue.GetBus(name)); });
+        } else if (kind == 5) {
+            const string stop = stop_name(next_stop++);
+            const string bus = "Bus " + to_string(next_bus++);
+            const Coordinates coordinates{random_lat(random), random_lng(random)};
+            const vector<string> stops{random_stop(), stop, random_stop()};
+            network.stops[stop] = coordinates;
+            network.buses[bus] = {stops, false};
+            update_seconds += MeasureSeconds([&] {
+                catalogue.AddStop(stop, coordinates);
+                catalogue.AddBus(bus, vector<string_view>(stops.begin(), stops.end()), false);
+            });
+        } else {
+            // Удаляется остановка без автобусов: сначала уводим с неё маршруты
+            const string name = stop_name(next_stop++);
+            network.stops[name] = {random_lat(random), random_lng(random)};
+            catalogue.AddStop(name, network.stops[name]);
+            network.stops.erase(name);
+            update_seconds += MeasureSeconds([&] { catalogue.RemoveStop(*catalogue.GetStop(name)); });
+        }
+        ++applied;
+    }
+
+    // Расстояния от и до удалённых в эталоне остановок не задаются
+    for (auto it = network.distances.begin(); it != network.distances.end();) {
+        const bool dangling = !network.stops.count(it->first.first) || !network.stops.count(it->first.second);
+        it = dangling ? network.distances.erase(it) : next(it);
+    }
+
+    TransportCatalogue expected;
+    Build(network, expected);
+    const int live_mismatches = CountMismatches(network, catalogue, expected);
+
+    const double compact_seconds = MeasureSeconds([&] { catalogue.BuildIndexes(); });
+    const int compacted_mismatches = CountMismatches(network, catalogue, expected);
+
+    cout << "stops: " << stop_count << ", buses: " << bus_count << ", changes: " << applied << "\n"
+         << "full build: " << build_seconds * 1e3 << " ms\n"
+         << "apply changes: " << update_seconds * 1e6 << " us total, "
+         << update_seconds * 1e6 / max<size_t>(applied, 1) << " us/change\n"
+         << "fold changes into indexes (BuildIndexes): " << compact_seconds * 1e3 << " ms\n"
+         << "mismatches with rebuilt catalogue: " << live_mismatches << " live, "
+         << compacted_mismatches << " after BuildIndexes\n";
+
+    return live_mismatches == 0 && compacted_mismatches == 0 ? 0 : 1;
+}
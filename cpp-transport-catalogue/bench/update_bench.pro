@@ -0,0 +1,16 @@
+CONFIG += c++20 cmdline
+CONFIG -= qt
+CONFIG += thread
+QMAKE_CXXFLAGS += -ffp-contract=off
+
+SOURCES += \
+    update_bench.cpp \
+    ../geo.cpp \
+    ../name_interner.cpp \
+    ../transport_catalogue.cpp
+
+HEADERS += \
+    ../geo.h \
+    ../name_interner.h \
+    ../parallel.h \
+    ../transport_catalogue.h
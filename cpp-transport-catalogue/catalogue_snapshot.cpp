@@ -0,0 +1,378 @@
+#include "catalogue_snapshot.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace transport_catalogue {
+
+namespace {
+
+constexpr char kMagic[8] = {'T', 'C', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kEmptySlot = UINT32_MAX;
+
+enum SectionId : uint32_t {
+    kStrings,
+    kStopNameOffsets,
+    kStopCoordinates,
+    kStopHash,
+    kBusNameOffsets,
+    kBusStopOffsets,
+    kBusStops,
+    kBusRoundtrip,
+    kRouteInfo,
+    kBusHash,
+    kStopBusOffsets,
+    kStopBusIds,
+    kDistanceOffsets,
+    kDistanceTo,
+    kDistanceMeters,
+    kSectionCount
+};
+
+struct Section {
+    uint64_t offset; // от начала файла
+    uint64_t size;   // в байтах
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t section_count;
+    uint64_t stop_count;
+    uint64_t bus_count;
+    Section sections[kSectionCount];
+};
+
+static_assert(sizeof(RouteInfo) == 32, "RouteInfo layout is part of the snapshot format");
+static_assert(sizeof(Coordinates) == 16, "Coordinates layout is part of the snapshot format");
+
+// FNV-1a: значение не зависит от реализации стандартной библиотеки
+uint64_t HashName(std::string_view name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : name) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Открытая адресация с линейным пробированием, в ячейках - номера имён
+std::vector<uint32_t> BuildNameHash(const std::vector<std::pair<std::string_view, uint32_t>>& name_to_id) {
+    size_t capacity = 1;
+    while (capacity < name_to_id.size() * 2) {
+        capacity *= 2;
+    }
+
+    std::vector<uint32_t> table(capacity, kEmptySlot);
+    for (const auto& [name, id] : name_to_id) {
+        size_t slot = HashName(name) & (capacity - 1);
+        while (table[slot] != kEmptySlot) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        table[slot] = id;
+    }
+    return table;
+}
+
+template <typename Container>
+std::vector<uint64_t> BuildNameOffsets(const Container& names, std::string& strings) {
+    std::vector<uint64_t> offsets;
+    offsets.reserve(names.size() + 1);
+    offsets.push_back(strings.size());
+    for (const auto& name : names) {
+        strings += name;
+        offsets.push_back(strings.size());
+    }
+    return offsets;
+}
+
+class SnapshotFile {
+public:
+    template <typename T>
+    void Add(SectionId id, std::span<const T> data) {
+        payload_.resize((payload_.size() + 7) / 8 * 8, '\0');
+        header_.sections[id] = {sizeof(Header) + payload_.size(), data.size_bytes()};
+        payload_.append(reinterpret_cast<const char*>(data.data()), data.size_bytes());
+    }
+
+    void Write(const std::string& path, uint64_t stop_count, uint64_t bus_count) {
+        std::memcpy(header_.magic, kMagic, sizeof(kMagic));
+        header_.version = kVersion;
+        header_.section_count = kSectionCount;
+        header_.stop_count = stop_count;
+        header_.bus_count = bus_count;
+
+        // Файл подменяется переименованием: справочник, отображённый из прежнего
+        // снимка по тому же пути, продолжает читать свои данные
+        const std::string temporary_path = path + ".tmp";
+        {
+            std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+            out.write(payload_.data(), payload_.size());
+            if (!out.flush()) {
+                std::remove(temporary_path.c_str());
+                throw std::runtime_error("Failed to write snapshot " + path);
+            }
+        }
+        if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+            std::remove(temporary_path.c_str());
+            throw std::runtime_error("Failed to write snapshot " + path);
+        }
+    }
+
+private:
+    Header header_{};
+    std::string payload_;
+};
+
+template <typename T>
+std::span<const T> SectionSpan(const char* base, const Section& section) {
+    return {reinterpret_cast<const T*>(base + section.offset), section.size / sizeof(T)};
+}
+
+} // namespace
+
+
+void SaveSnapshot(const TransportCatalogue& catalogue, const std::string& path) {
+
+    if (catalogue.HasPendingUpdates()) {
+        throw std::logic_error("BuildIndexes() must be called before SaveSnapshot()");
+    }
+
+    const size_t stop_count = catalogue.StopCount();
+    const size_t bus_count = catalogue.BusCount();
+
+    std::string strings;
+    const auto stop_name_offsets = BuildNameOffsets(catalogue.stop_names_, strings);
+    const auto bus_name_offsets = BuildNameOffsets(catalogue.bus_names_, strings);
+
+    std::vector<uint8_t> bus_is_roundtrip(catalogue.bus_is_roundtrip_.begin(), catalogue.bus_is_roundtrip_.end());
+
+    std::vector<RouteInfo> route_info;
+    route_info.reserve(bus_count);
+    for (BusId bus = 0; bus < bus_count; ++bus) {
+        route_info.push_back(catalogue.GetRouteInfo(bus));
+    }
+
+    std::vector<uint32_t> stop_bus_offsets{0};
+    std::vector<BusId> stop_bus_ids;
+    for (StopId stop = 0; stop < stop_count; ++stop) {
+        const auto buses = catalogue.GetBusesForStop(stop);
+        stop_bus_ids.insert(stop_bus_ids.end(), buses.begin(), buses.end());
+        stop_bus_offsets.push_back(static_cast<uint32_t>(stop_bus_ids.size()));
+    }
+
+    // Остановки, добавленные после построения индекса, получают пустые строки
+    std::vector<uint32_t> distance_offsets = catalogue.distance_offsets_;
+    if (distance_offsets.empty()) {
+        distance_offsets.push_back(0);
+    }
+    distance_offsets.resize(stop_count + 1, distance_offsets.back());
+
+    // Одно имя может быть у нескольких остановок, в таблицу попадает та, что находит GetStop
+    std::vector<std::pair<std::string_view, uint32_t>> stop_names;
+    std::vector<std::pair<std::string_view, uint32_t>> bus_names;
+    for (StopId stop = 0; stop < stop_count; ++stop) {
+        if (catalogue.GetStop(catalogue.GetStopName(stop)) == stop) {
+            stop_names.emplace_back(catalogue.GetStopName(stop), stop);
+        }
+    }
+    for (BusId bus = 0; bus < bus_count; ++bus) {
+        if (catalogue.GetBus(catalogue.GetBusName(bus)) == bus) {
+            bus_names.emplace_back(catalogue.GetBusName(bus), bus);
+        }
+    }
+    const auto stop_hash = BuildNameHash(stop_names);
+    const auto bus_hash = BuildNameHash(bus_names);
+
+    SnapshotFile file;
+    file.Add<char>(kStrings, strings);
+    file.Add<uint64_t>(kStopNameOffsets, stop_name_offsets);
+    file.Add<Coordinates>(kStopCoordinates, catalogue.stop_coordinates_);
+    file.Add<uint32_t>(kStopHash, stop_hash);
+    file.Add<uint64_t>(kBusNameOffsets, bus_name_offsets);
+    file.Add<uint32_t>(kBusStopOffsets, catalogue.bus_stop_offsets_);
+    file.Add<StopId>(kBusStops, catalogue.bus_stops_);
+    file.Add<uint8_t>(kBusRoundtrip, bus_is_roundtrip);
+    file.Add<RouteInfo>(kRouteInfo, route_info);
+    file.Add<uint32_t>(kBusHash, bus_hash);
+    file.Add<uint32_t>(kStopBusOffsets, stop_bus_offsets);
+    file.Add<BusId>(kStopBusIds, stop_bus_ids);
+    file.Add<uint32_t>(kDistanceOffsets, distance_offsets);
+    file.Add<StopId>(kDistanceTo, catalogue.distance_to_);
+    file.Add<int>(kDistanceMeters, catalogue.distance_meters_);
+    file.Write(path, stop_count, bus_count);
+}
+
+
+MappedCatalogue::MappedCatalogue(const std::string& path) {
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open snapshot " + path);
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        throw std::runtime_error("Snapshot is too small: " + path);
+    }
+
+    size_ = st.st_size;
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::runtime_error("Cannot map snapshot " + path);
+    }
+
+    const char* base = static_cast<const char*>(data_);
+    const Header& header = *reinterpret_cast<const Header*>(base);
+
+    auto fail = [&](const char* reason) {
+        munmap(data_, size_);
+        data_ = nullptr;
+        throw std::runtime_error(std::string("Invalid snapshot ") + path + ": " + reason);
+    };
+
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        fail("bad magic");
+    }
+    if (header.version != kVersion || header.section_count != kSectionCount) {
+        fail("unsupported version");
+    }
+    for (const Section& section : header.sections) {
+        if (section.offset % 8 != 0 || section.offset > size_ || section.size > size_ - section.offset) {
+            fail("section out of bounds");
+        }
+    }
+
+    const auto& sections = header.sections;
+    strings_ = {base + sections[kStrings].offset, sections[kStrings].size};
+
+    stop_name_offsets_ = SectionSpan<uint64_t>(base, sections[kStopNameOffsets]);
+    stop_coordinates_ = SectionSpan<Coordinates>(base, sections[kStopCoordinates]);
+    stop_hash_ = SectionSpan<uint32_t>(base, sections[kStopHash]);
+
+    bus_name_offsets_ = SectionSpan<uint64_t>(base, sections[kBusNameOffsets]);
+    bus_stop_offsets_ = SectionSpan<uint32_t>(base, sections[kBusStopOffsets]);
+    bus_stops_ = SectionSpan<StopId>(base, sections[kBusStops]);
+    bus_is_roundtrip_ = SectionSpan<uint8_t>(base, sections[kBusRoundtrip]);
+    route_info_ = SectionSpan<RouteInfo>(base, sections[kRouteInfo]);
+    bus_hash_ = SectionSpan<uint32_t>(base, sections[kBusHash]);
+
+    stop_bus_offsets_ = SectionSpan<uint32_t>(base, sections[kStopBusOffsets]);
+    stop_bus_ids_ = SectionSpan<BusId>(base, sections[kStopBusIds]);
+
+    distance_offsets_ = SectionSpan<uint32_t>(base, sections[kDistanceOffsets]);
+    distance_to_ = SectionSpan<StopId>(base, sections[kDistanceTo]);
+    distance_meters_ = SectionSpan<int>(base, sections[kDistanceMeters]);
+
+    const size_t stops = header.stop_count;
+    const size_t buses = header.bus_count;
+    if (stop_name_offsets_.size() != stops + 1 || stop_coordinates_.size() != stops
+        || stop_bus_offsets_.size() != stops + 1 || distance_offsets_.size() != stops + 1
+        || bus_name_offsets_.size() != buses + 1 || bus_stop_offsets_.size() != buses + 1
+        || bus_is_roundtrip_.size() != buses || route_info_.size() != buses
+        || stop_hash_.empty() || bus_hash_.empty()
+        || std::max(stop_name_offsets_.back(), bus_name_offsets_.back()) > strings_.size()
+        || bus_stop_offsets_.back() > bus_stops_.size() || stop_bus_offsets_.back() > stop_bus_ids_.size()
+        || distance_offsets_.back() > distance_to_.size() || distance_to_.size() != distance_meters_.size()) {
+        fail("inconsistent section sizes");
+    }
+}
+
+MappedCatalogue::~MappedCatalogue() {
+    if (data_) {
+        munmap(data_, size_);
+    }
+}
+
+std::optional<uint32_t> MappedCatalogue::FindName(std::span<const uint32_t> table,
+                                                  std::span<const uint64_t> name_offsets, std::string_view name) const {
+
+    const size_t mask = table.size() - 1;
+    for (size_t slot = HashName(name) & mask; table[slot] != kEmptySlot; slot = (slot + 1) & mask) {
+        const uint32_t id = table[slot];
+        if (strings_.substr(name_offsets[id], name_offsets[id + 1] - name_offsets[id]) == name) {
+            return id;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<BusId> MappedCatalogue::GetBus(std::string_view name) const {
+    return FindName(bus_hash_, bus_name_offsets_, name);
+}
+
+std::optional<StopId> MappedCatalogue::GetStop(std::string_view name) const {
+    return FindName(stop_hash_, stop_name_offsets_, name);
+}
+
+size_t MappedCatalogue::StopCount() const {
+    return stop_coordinates_.size();
+}
+
+size_t MappedCatalogue::BusCount() const {
+    return route_info_.size();
+}
+
+std::string_view MappedCatalogue::GetStopName(StopId stop) const {
+    return strings_.substr(stop_name_offsets_[stop], stop_name_offsets_[stop + 1] - stop_name_offsets_[stop]);
+}
+
+Coordinates MappedCatalogue::GetStopCoordinates(StopId stop) const {
+    return stop_coordinates_[stop];
+}
+
+std::string_view MappedCatalogue::GetBusName(BusId bus) const {
+    return strings_.substr(bus_name_offsets_[bus], bus_name_offsets_[bus + 1] - bus_name_offsets_[bus]);
+}
+
+std::span<const StopId> MappedCatalogue::GetBusStops(BusId bus) const {
+    return bus_stops_.subspan(bus_stop_offsets_[bus], bus_stop_offsets_[bus + 1] - bus_stop_offsets_[bus]);
+}
+
+bool MappedCatalogue::IsRoundtrip(BusId bus) const {
+    return bus_is_roundtrip_[bus] != 0;
+}
+
+std::span<const BusId> MappedCatalogue::GetBusesForStop(StopId stop) const {
+    return stop_bus_ids_.subspan(stop_bus_offsets_[stop], stop_bus_offsets_[stop + 1] - stop_bus_offsets_[stop]);
+}
+
+RouteInfo MappedCatalogue::GetRouteInfo(BusId bus) const {
+    return route_info_[bus];
+}
+
+int MappedCatalogue::GetDistance(StopId from, StopId to) const {
+
+    if (auto distance = FindDistance(from, to)) {
+        return *distance;
+    }
+    // Расстояние в обратном направлении
+    if (auto distance = FindDistance(to, from)) {
+        return *distance;
+    }
+    return 0;
+}
+
+std::optional<int> MappedCatalogue::FindDistance(StopId from, StopId to) const {
+
+    const auto first = distance_to_.begin() + distance_offsets_[from];
+    const auto last = distance_to_.begin() + distance_offsets_[from + 1];
+    const auto it = std::lower_bound(first, last, to);
+    if (it != last && *it == to) {
+        return distance_meters_[it - distance_to_.begin()];
+    }
+    return std::nullopt;
+}
+
+} // namespace transport_catalogue
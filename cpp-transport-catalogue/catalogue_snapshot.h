@@ -0,0 +1,87 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <span>
+#include "transport_catalogue.h"
+
+
+namespace transport_catalogue {
+
+/**
+ * Сохраняет справочник в бинарный снимок. Перед сохранением должны быть
+ * построены индексы (BuildIndexes), иначе бросается std::logic_error.
+ *
+ * Снимок содержит таблицу строк, координаты, остановки маршрутов, статистику
+ * маршрутов, индексы расстояний и автобусов по остановкам и хеш-таблицы имён.
+ * Все ссылки внутри файла - смещения от его начала, секции выровнены по 8 байт,
+ * поэтому файл можно читать прямо из отображённой памяти. Порядок байт - родной
+ * для машины, на которой снимок записан. Снимок пишется во временный файл рядом
+ * и переименовывается, поэтому MappedCatalogue прежнего снимка по тому же пути
+ * не видит частично записанных данных
+ */
+void SaveSnapshot(const TransportCatalogue& catalogue, const std::string& path);
+
+/**
+ * Справочник, который обслуживает запросы прямо из отображённого в память снимка,
+ * без разбора и копирования данных. Снимок считается доверенным: проверяются
+ * заголовок и границы секций, но не содержимое
+ */
+class MappedCatalogue final : public CatalogueView {
+public:
+    // Бросает std::runtime_error, если файл не открывается или не является снимком
+    explicit MappedCatalogue(const std::string& path);
+
+    MappedCatalogue(const MappedCatalogue&) = delete;
+    MappedCatalogue& operator=(const MappedCatalogue&) = delete;
+    ~MappedCatalogue() override;
+
+    std::optional<BusId> GetBus( std::string_view name) const override;
+    std::optional<StopId> GetStop(std::string_view name) const override;
+
+    size_t StopCount() const override;
+    size_t BusCount() const override;
+
+    std::string_view GetStopName(StopId stop) const override;
+    Coordinates GetStopCoordinates(StopId stop) const override;
+
+    std::string_view GetBusName(BusId bus) const override;
+    std::span<const StopId> GetBusStops(BusId bus) const override;
+    bool IsRoundtrip(BusId bus) const override;
+
+    using CatalogueView::GetBusesForStop;
+    std::span<const BusId> GetBusesForStop(StopId stop) const override;
+
+    RouteInfo GetRouteInfo(BusId bus) const override;
+
+    int GetDistance(StopId from, StopId to) const override;
+
+private:
+    std::optional<int> FindDistance(StopId from, StopId to) const;
+    std::optional<uint32_t> FindName(std::span<const uint32_t> table,
+                                     std::span<const uint64_t> name_offsets, std::string_view name) const;
+
+    void* data_ = nullptr;
+    size_t size_ = 0;
+
+    std::string_view strings_;
+
+    std::span<const uint64_t> stop_name_offsets_;
+    std::span<const Coordinates> stop_coordinates_;
+    std::span<const uint32_t> stop_hash_;
+
+    std::span<const uint64_t> bus_name_offsets_;
+    std::span<const uint32_t> bus_stop_offsets_;
+    std::span<const StopId> bus_stops_;
+    std::span<const uint8_t> bus_is_roundtrip_;
+    std::span<const RouteInfo> route_info_;
+    std::span<const uint32_t> bus_hash_;
+
+    std::span<const uint32_t> stop_bus_offsets_;
+    std::span<const BusId> stop_bus_ids_;
+
+    std::span<const uint32_t> distance_offsets_;
+    std::span<const StopId> distance_to_;
+    std::span<const int> distance_meters_;
+};
+
+} // namespace transport_catalogue
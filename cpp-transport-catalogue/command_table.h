@@ -0,0 +1,112 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <variant>
+
+
+namespace dispatch {
+
+/**
+ * Таблица имён команд с совершенным хешем, построенным при компиляции.
+ * Поиск стоит одного хеширования по первой, средней и последней букве и длине
+ * и одного сравнения строк, сколько бы команд ни было в таблице.
+ * Множитель хеша подбирается в конструкторе так, чтобы имена не совпали
+ * по ячейкам; если подобрать не удалось, constexpr-таблица не скомпилируется
+ */
+template <size_t N>
+class CommandTable {
+public:
+    static constexpr size_t kNotFound = N;
+
+    constexpr explicit CommandTable(const std::array<std::string_view, N>& names)
+        : names_(names) {
+
+        static_assert(N < kSlotCount / 2, "Too many commands for the table");
+        for (uint32_t seed = 0; seed < 256; ++seed) {
+            multiplier_ = 0x9E3779B1u * (2 * seed + 1);
+            if (TryFill()) {
+                return;
+            }
+        }
+        throw std::logic_error("Command names collide in every hash seed");
+    }
+
+    // Номер имени в списке конструктора или kNotFound
+    constexpr size_t Find(std::string_view name) const {
+        if (name.empty()) {
+            return kNotFound;
+        }
+        const size_t index = slots_[Slot(name)];
+        return index != kNotFound && names_[index] == name ? index : kNotFound;
+    }
+
+private:
+    static constexpr size_t kSlotBits = 6;
+    static constexpr size_t kSlotCount = size_t{1} << kSlotBits;
+
+    constexpr size_t Slot(std::string_view name) const {
+        const uint32_t key = static_cast<unsigned char>(name.front())
+                             | static_cast<uint32_t>(static_cast<unsigned char>(name.back())) << 8
+                             | static_cast<uint32_t>(static_cast<unsigned char>(name[name.size() / 2])) << 16
+                             | static_cast<uint32_t>(name.size()) << 24;
+        return static_cast<uint32_t>(key * multiplier_) >> (32 - kSlotBits);
+    }
+
+    constexpr bool TryFill() {
+        slots_.fill(kNotFound);
+        for (size_t i = 0; i < N; ++i) {
+            auto& slot = slots_[Slot(names_[i])];
+            if (slot != kNotFound) {
+                return false;
+            }
+            slot = i;
+        }
+        return true;
+    }
+
+    std::array<std::string_view, N> names_;
+    std::array<uint8_t, kSlotCount> slots_{};
+    uint32_t multiplier_ = 0;
+};
+
+/**
+ * Набор типизированных команд. Каждый тип Command задаёт имя
+ * static constexpr std::string_view kName и разбор аргументов
+ * static std::optional<Command> Parse(std::string_view args).
+ * Результат разбора - Parsed, его можно выполнить через std::visit сколько угодно раз.
+ * Новая команда добавляется в список типов и не замедляет разбор остальных
+ */
+template <typename... Commands>
+class CommandSet {
+public:
+    // monostate - неизвестная команда или неразборчивые аргументы
+    using Parsed = std::variant<std::monostate, Commands...>;
+
+    static constexpr size_t kNotFound = sizeof...(Commands);
+
+    static constexpr size_t Find(std::string_view name) {
+        return kTable.Find(name);
+    }
+
+    static Parsed Parse(std::string_view name, std::string_view args) {
+        const size_t index = Find(name);
+        return index == kNotFound ? Parsed{} : kParsers[index](args);
+    }
+
+private:
+    template <typename Command>
+    static Parsed ParseAs(std::string_view args) {
+        if (auto command = Command::Parse(args)) {
+            return std::move(*command);
+        }
+        return {};
+    }
+
+    static constexpr CommandTable<sizeof...(Commands)> kTable{{Commands::kName...}};
+    static constexpr std::array<Parsed (*)(std::string_view), sizeof...(Commands)> kParsers{&ParseAs<Commands>...};
+};
+
+} // namespace dispatch
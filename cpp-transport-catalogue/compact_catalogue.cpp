@@ -0,0 +1,246 @@
+#include "compact_catalogue.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace transport_catalogue {
+
+namespace {
+
+void AppendVarint(std::vector<uint8_t>& bytes, uint32_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t ReadVarint(const uint8_t*& pos) {
+    uint32_t value = 0;
+    int shift = 0;
+    while (*pos & 0x80) {
+        value |= static_cast<uint32_t>(*pos++ & 0x7F) << shift;
+        shift += 7;
+    }
+    return value | static_cast<uint32_t>(*pos++) << shift;
+}
+
+// Разность номеров со знаком кодируется так, чтобы малые по модулю занимали один байт.
+// Номера складываются по модулю 2^32, поэтому разность любых двух номеров восстанавливается
+uint32_t EncodeDelta(uint32_t from, uint32_t to) {
+    const auto delta = static_cast<int32_t>(to - from);
+    return (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+}
+
+uint32_t DecodeDelta(uint32_t from, uint32_t encoded) {
+    return from + ((encoded >> 1) ^ (0u - (encoded & 1)));
+}
+
+// Смещения строк хранятся в 32 битах
+uint32_t CheckedOffset(size_t size) {
+    if (size > UINT32_MAX) {
+        throw std::length_error("Compact catalogue section exceeds 4 GiB");
+    }
+    return static_cast<uint32_t>(size);
+}
+
+// Координата без значения (NaN у неразобранной или удалённой остановки) -
+// INT32_MIN, остальные значения лежат в [-INT32_MAX, INT32_MAX] и с ним не совпадают
+constexpr int32_t kNoCoordinate = INT32_MIN;
+
+int32_t ToFixed(double degrees, double scale) {
+    if (!std::isfinite(degrees)) {
+        return kNoCoordinate;
+    }
+    const double fixed = std::round(degrees * scale);
+    if (fixed > INT32_MAX || fixed < -INT32_MAX) {
+        throw std::out_of_range("Coordinate out of compact catalogue range");
+    }
+    return static_cast<int32_t>(fixed);
+}
+
+double FromFixed(int32_t fixed, double scale) {
+    return fixed == kNoCoordinate ? std::numeric_limits<double>::quiet_NaN() : fixed / scale;
+}
+
+} // namespace
+
+
+CompactCatalogue::CompactCatalogue(const TransportCatalogue& source) {
+
+    if (source.HasPendingUpdates()) {
+        throw std::logic_error("BuildIndexes() must be called before building CompactCatalogue");
+    }
+
+    const size_t stop_count = source.StopCount();
+    const size_t bus_count = source.BusCount();
+
+    // Одно имя может быть у нескольких остановок, по имени находится та же, что у source
+    stop_name_ids_.reserve(stop_count);
+    stop_coordinates_.reserve(stop_count);
+    for (StopId stop = 0; stop < stop_count; ++stop) {
+        const std::string_view name = source.GetStopName(stop);
+        const uint32_t name_id = names_.Intern(name);
+        stop_name_ids_.push_back(name_id);
+        if (source.GetStop(name) == stop) {
+            if (name_to_stop_.size() <= name_id) {
+                name_to_stop_.resize(name_id + 1, kNoId);
+            }
+            name_to_stop_[name_id] = stop;
+        }
+
+        const Coordinates coordinates = source.GetStopCoordinates(stop);
+        stop_coordinates_.push_back({ToFixed(coordinates.lat, kCoordinateScale),
+                                     ToFixed(coordinates.lng, kCoordinateScale)});
+    }
+
+    // Остановки, добавленные после построения индекса, получают пустые строки
+    distance_offsets_.reserve(stop_count + 1);
+    distance_offsets_.push_back(0);
+    for (StopId from = 0; from < stop_count; ++from) {
+        if (from + 1 < source.distance_offsets_.size()) {
+            StopId previous = from;
+            for (uint32_t i = source.distance_offsets_[from]; i < source.distance_offsets_[from + 1]; ++i) {
+                AppendVarint(distance_bytes_, EncodeDelta(previous, source.distance_to_[i]));
+                AppendVarint(distance_bytes_, static_cast<uint32_t>(source.distance_meters_[i]));
+                previous = source.distance_to_[i];
+            }
+        }
+        distance_offsets_.push_back(CheckedOffset(distance_bytes_.size()));
+    }
+    distance_bytes_.shrink_to_fit();
+
+    stop_bus_offsets_.reserve(stop_count + 1);
+    stop_bus_offsets_.push_back(0);
+    for (StopId stop = 0; stop < stop_count; ++stop) {
+        const auto buses = source.GetBusesForStop(stop);
+        stop_bus_ids_.insert(stop_bus_ids_.end(), buses.begin(), buses.end());
+        stop_bus_offsets_.push_back(CheckedOffset(stop_bus_ids_.size()));
+    }
+    stop_bus_ids_.shrink_to_fit();
+
+    bus_name_ids_.reserve(bus_count);
+    bus_stop_offsets_.reserve(bus_count + 1);
+    bus_stop_offsets_.push_back(0);
+    route_info_.reserve(bus_count);
+    for (BusId bus = 0; bus < bus_count; ++bus) {
+        const std::string_view name = source.GetBusName(bus);
+        const uint32_t name_id = names_.Intern(name);
+        bus_name_ids_.push_back(name_id);
+        if (source.GetBus(name) == bus) {
+            if (name_to_bus_.size() <= name_id) {
+                name_to_bus_.resize(name_id + 1, kNoId);
+            }
+            name_to_bus_[name_id] = bus;
+        }
+
+        StopId previous = 0;
+        for (StopId stop : source.GetBusStops(bus)) {
+            AppendVarint(bus_stop_bytes_, EncodeDelta(previous, stop));
+            previous = stop;
+        }
+        bus_stop_offsets_.push_back(CheckedOffset(bus_stop_bytes_.size()));
+        bus_is_roundtrip_.push_back(source.IsRoundtrip(bus));
+        route_info_.push_back(source.GetRouteInfo(bus));
+    }
+    bus_stop_bytes_.shrink_to_fit();
+}
+
+std::optional<BusId> CompactCatalogue::GetBus(std::string_view name) const {
+
+    if (auto name_id = names_.Find(name); name_id && *name_id < name_to_bus_.size()
+                                              && name_to_bus_[*name_id] != kNoId) {
+        return name_to_bus_[*name_id];
+    }
+    return std::nullopt;
+}
+
+std::optional<StopId> CompactCatalogue::GetStop(std::string_view name) const {
+
+    if (auto name_id = names_.Find(name); name_id && *name_id < name_to_stop_.size()
+                                               && name_to_stop_[*name_id] != kNoId) {
+        return name_to_stop_[*name_id];
+    }
+    return std::nullopt;
+}
+
+size_t CompactCatalogue::StopCount() const {
+    return stop_name_ids_.size();
+}
+
+size_t CompactCatalogue::BusCount() const {
+    return bus_name_ids_.size();
+}
+
+std::string_view CompactCatalogue::GetStopName(StopId stop) const {
+    return names_.Get(stop_name_ids_[stop]);
+}
+
+Coordinates CompactCatalogue::GetStopCoordinates(StopId stop) const {
+    const FixedCoordinates coordinates = stop_coordinates_[stop];
+    return {FromFixed(coordinates.lat, kCoordinateScale), FromFixed(coordinates.lng, kCoordinateScale)};
+}
+
+std::string_view CompactCatalogue::GetBusName(BusId bus) const {
+    return names_.Get(bus_name_ids_[bus]);
+}
+
+std::span<const StopId> CompactCatalogue::GetBusStops(BusId bus) const {
+
+    // Буфер переиспользуется между вызовами одного потока
+    thread_local std::vector<StopId> stops;
+    stops.clear();
+
+    const uint8_t* pos = bus_stop_bytes_.data() + bus_stop_offsets_[bus];
+    const uint8_t* const end = bus_stop_bytes_.data() + bus_stop_offsets_[bus + 1];
+    StopId stop = 0;
+    while (pos < end) {
+        stop = DecodeDelta(stop, ReadVarint(pos));
+        stops.push_back(stop);
+    }
+    return stops;
+}
+
+bool CompactCatalogue::IsRoundtrip(BusId bus) const {
+    return bus_is_roundtrip_[bus];
+}
+
+std::span<const BusId> CompactCatalogue::GetBusesForStop(StopId stop) const {
+    return std::span<const BusId>(stop_bus_ids_).subspan(
+        stop_bus_offsets_[stop], stop_bus_offsets_[stop + 1] - stop_bus_offsets_[stop]);
+}
+
+RouteInfo CompactCatalogue::GetRouteInfo(BusId bus) const {
+    return route_info_[bus];
+}
+
+int CompactCatalogue::GetDistance(StopId from, StopId to) const {
+
+    if (auto distance = FindDistance(from, to)) {
+        return *distance;
+    }
+    // Расстояние в обратном направлении
+    if (auto distance = FindDistance(to, from)) {
+        return *distance;
+    }
+    return 0;
+}
+
+std::optional<int> CompactCatalogue::FindDistance(StopId from, StopId to) const {
+
+    // Строки короткие, поэтому их читают подряд; соседи упорядочены, и чтение
+    // прекращается на первом соседе с номером больше искомого
+    const uint8_t* pos = distance_bytes_.data() + distance_offsets_[from];
+    const uint8_t* const end = distance_bytes_.data() + distance_offsets_[from + 1];
+    StopId neighbour = from;
+    while (pos < end) {
+        neighbour = DecodeDelta(neighbour, ReadVarint(pos));
+        const auto meters = static_cast<int>(ReadVarint(pos));
+        if (neighbour >= to) {
+            return neighbour == to ? std::optional<int>(meters) : std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace transport_catalogue
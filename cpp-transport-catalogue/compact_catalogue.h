@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "name_interner.h"
+#include "transport_catalogue.h"
+
+
+namespace transport_catalogue {
+
+/**
+ * Компактный справочник только для чтения для очень больших сетей. Строится из
+ * TransportCatalogue с построенными индексами, после чего исходный можно удалить.
+ *
+ * Координаты хранятся в фиксированной точке - градусы * 1e7 в int32. Погрешность
+ * координаты не больше 5e-8 градуса, то есть 5.6 мм по меридиану и не больше по
+ * параллели, поэтому географическое расстояние между остановками отличается от
+ * исходного не больше чем на 1.6 см. Координаты, заданные не более чем семью
+ * знаками после запятой, восстанавливаются точно. Координата без значения (NaN
+ * или бесконечность) восстанавливается как NaN.
+ * Статистика маршрутов (RouteInformation) берётся из исходного справочника и
+ * совпадает с ним точно, дорожные расстояния и остановки маршрутов - тоже.
+ *
+ * Расстояния остановки - строка байтов: соседи по возрастанию номеров, разность
+ * с предыдущим номером и метры в varint. Остановки маршрута - разности соседних
+ * номеров в varint. Автобусы остановок хранятся как в TransportCatalogue.
+ *
+ * GetBusStops распаковывает маршрут в буфер потока: span действителен
+ * до следующего вызова GetBusStops в том же потоке
+ */
+class CompactCatalogue final : public CatalogueView {
+public:
+    // Бросает std::logic_error, если у source есть изменения после BuildIndexes(),
+    // и std::out_of_range, если координата остановки по модулю больше 214.7 градуса
+    explicit CompactCatalogue(const TransportCatalogue& source);
+
+    CompactCatalogue(const CompactCatalogue&) = delete;
+    CompactCatalogue& operator=(const CompactCatalogue&) = delete;
+
+    std::optional<BusId> GetBus( std::string_view name) const override;
+    std::optional<StopId> GetStop(std::string_view name) const override;
+
+    size_t StopCount() const override;
+    size_t BusCount() const override;
+
+    std::string_view GetStopName(StopId stop) const override;
+    Coordinates GetStopCoordinates(StopId stop) const override;
+
+    std::string_view GetBusName(BusId bus) const override;
+    std::span<const StopId> GetBusStops(BusId bus) const override;
+    bool IsRoundtrip(BusId bus) const override;
+
+    using CatalogueView::GetBusesForStop;
+    std::span<const BusId> GetBusesForStop(StopId stop) const override;
+
+    RouteInfo GetRouteInfo(BusId bus) const override;
+
+    int GetDistance(StopId from, StopId to) const override;
+
+private:
+    static constexpr double kCoordinateScale = 1e7;
+    static constexpr uint32_t kNoId = UINT32_MAX;
+
+    struct FixedCoordinates {
+        int32_t lat;
+        int32_t lng;
+    };
+
+    std::optional<int> FindDistance(StopId from, StopId to) const;
+
+    // Имена остановок и маршрутов, у каждой остановки и маршрута - номер имени
+    NameInterner names_;
+    std::vector<StopId> name_to_stop_;  // индекс - номер имени, kNoId, если остановки с таким именем нет
+    std::vector<BusId> name_to_bus_;
+
+    std::vector<uint32_t> stop_name_ids_;
+    std::vector<FixedCoordinates> stop_coordinates_;
+
+    // Строка расстояний остановки i - [distance_offsets_[i], distance_offsets_[i + 1]) в distance_bytes_
+    std::vector<uint32_t> distance_offsets_;
+    std::vector<uint8_t> distance_bytes_;
+
+    std::vector<uint32_t> stop_bus_offsets_;
+    std::vector<BusId> stop_bus_ids_;
+
+    std::vector<uint32_t> bus_name_ids_;
+    // Остановки маршрута i - [bus_stop_offsets_[i], bus_stop_offsets_[i + 1]) в bus_stop_bytes_
+    std::vector<uint32_t> bus_stop_offsets_;
+    std::vector<uint8_t> bus_stop_bytes_;
+    std::vector<bool> bus_is_roundtrip_;
+    std::vector<RouteInfo> route_info_;
+};
+
+} // namespace transport_catalogue
@@ -0,0 +1,395 @@
+#include "contraction_hierarchy.h"
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+namespace router {
+
+namespace {
+
+// Поиск свидетеля обрывается после стольких вершин: лишнее сокращение
+// не нарушает корректность, а поиск на плотных участках графа ограничен
+constexpr size_t kWitnessSettleLimit = 64;
+
+// Начальные приоритеты оцениваются более коротким поиском свидетеля,
+// точный приоритет считается при извлечении вершины из очереди
+constexpr size_t kEstimateSettleLimit = 16;
+
+// Сжатие прекращается, когда очередная вершина добавила бы сокращений больше,
+// чем во столько раз её степень: граф уплотняется, и дальнейшее сжатие дороже выигрыша
+constexpr size_t kCoreDensity = 4;
+
+// Столько вершин проверяется до сжатия: если у типичной вершины сокращений больше
+// kCoreDensity степеней, иерархии в графе нет и весь граф сразу становится ядром
+constexpr size_t kDensitySampleSize = 256;
+
+using HeapEntry = std::pair<PathCost, uint32_t>;
+
+// Дейкстра с затронутыми вершинами: после поиска сбрасываются только они
+struct LocalSearch {
+    std::vector<PathCost> dist;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> touched;
+    std::vector<HeapEntry> heap;
+
+    void Prepare(size_t vertex_count) {
+        if (dist.size() < vertex_count) {
+            dist.resize(vertex_count, kInfiniteCost);
+            parent.resize(vertex_count, UINT32_MAX);
+        }
+    }
+
+    bool Relax(uint32_t vertex, PathCost distance, uint32_t arc) {
+        if (distance >= dist[vertex]) {
+            return false;
+        }
+        if (dist[vertex] == kInfiniteCost) {
+            touched.push_back(vertex);
+        }
+        dist[vertex] = distance;
+        parent[vertex] = arc;
+        heap.emplace_back(distance, vertex);
+        std::push_heap(heap.begin(), heap.end(), std::greater<>{});
+        return true;
+    }
+
+    // Следующая неустаревшая запись кучи или false, если куча пуста
+    bool Pop(HeapEntry& entry) {
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>{});
+            entry = heap.back();
+            heap.pop_back();
+            if (entry.first <= dist[entry.second]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    PathCost MinKey() const {
+        return heap.empty() ? kInfiniteCost : heap.front().first;
+    }
+
+    void Reset() {
+        for (uint32_t vertex : touched) {
+            dist[vertex] = kInfiniteCost;
+            parent[vertex] = UINT32_MAX;
+        }
+        touched.clear();
+        heap.clear();
+    }
+};
+
+struct QueryState {
+    LocalSearch forward;
+    LocalSearch backward;
+    std::vector<uint32_t> arcs;
+};
+
+thread_local QueryState query_state;
+
+} // namespace
+
+
+ContractionHierarchy::ContractionHierarchy(size_t vertex_count, const std::vector<InputEdge>& edges) {
+
+    // Из параллельных рёбер остаётся самое лёгкое, при равенстве - с меньшим номером.
+    // Петли в кратчайшие пути не входят
+    std::vector<uint32_t> order(edges.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&edges](uint32_t lhs, uint32_t rhs) {
+        const InputEdge& l = edges[lhs];
+        const InputEdge& r = edges[rhs];
+        return std::tie(l.from, l.to, l.cost) < std::tie(r.from, r.to, r.cost);
+    });
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        const InputEdge& edge = edges[order[i]];
+        if (edge.from == edge.to) {
+            continue;
+        }
+        if (i > 0 && edges[order[i - 1]].from == edge.from && edges[order[i - 1]].to == edge.to) {
+            continue;
+        }
+        arcs_.push_back({edge.from, edge.to, edge.cost, order[i], kNone, kNone});
+    }
+
+    Contract(vertex_count);
+    BuildSearchGraph(vertex_count);
+}
+
+void ContractionHierarchy::Contract(size_t vertex_count) {
+
+    std::vector<std::vector<uint32_t>> out(vertex_count);
+    std::vector<std::vector<uint32_t>> in(vertex_count);
+    for (uint32_t arc = 0; arc < arcs_.size(); ++arc) {
+        out[arcs_[arc].from].push_back(arc);
+        in[arcs_[arc].to].push_back(arc);
+    }
+
+    std::vector<char> contracted(vertex_count, 0);
+    std::vector<int> deleted_neighbors(vertex_count, 0);
+
+    // Убирает дуги в сжатые вершины и оставляет одну самую лёгкую дугу на соседа
+    auto prune = [this, &contracted](std::vector<uint32_t>& list, bool by_target) {
+        auto neighbor = [this, by_target](uint32_t arc) {
+            return by_target ? arcs_[arc].to : arcs_[arc].from;
+        };
+        std::erase_if(list, [&](uint32_t arc) { return contracted[neighbor(arc)] != 0; });
+        std::sort(list.begin(), list.end(), [&](uint32_t lhs, uint32_t rhs) {
+            return std::tuple(neighbor(lhs), arcs_[lhs].cost, lhs) < std::tuple(neighbor(rhs), arcs_[rhs].cost, rhs);
+        });
+        list.erase(std::unique(list.begin(), list.end(),
+                               [&](uint32_t lhs, uint32_t rhs) { return neighbor(lhs) == neighbor(rhs); }),
+                   list.end());
+    };
+
+    LocalSearch witness;
+    witness.Prepare(vertex_count);
+
+    // Сокращения, которые нужны при сжатии вершины v
+    std::vector<Arc> shortcuts;
+    auto find_shortcuts = [&](uint32_t v, size_t settle_limit) {
+        shortcuts.clear();
+        prune(in[v], false);
+        prune(out[v], true);
+
+        for (uint32_t in_arc : in[v]) {
+            const uint32_t u = arcs_[in_arc].from;
+
+            bool has_via = false;
+            PathCost max_via;
+            for (uint32_t out_arc : out[v]) {
+                if (arcs_[out_arc].to != u) {
+                    has_via = true;
+                    max_via = std::max(max_via, arcs_[in_arc].cost + arcs_[out_arc].cost);
+                }
+            }
+            if (!has_via) {
+                continue;
+            }
+
+            // Поиск пути из u в обход v не длиннее любого пути через v
+            witness.Relax(u, PathCost{}, kNone);
+            HeapEntry entry;
+            size_t settled = 0;
+            while (witness.Pop(entry) && entry.first <= max_via && ++settled <= settle_limit) {
+                for (uint32_t arc : out[entry.second]) {
+                    const uint32_t next = arcs_[arc].to;
+                    if (next != v && contracted[next] == 0) {
+                        witness.Relax(next, entry.first + arcs_[arc].cost, arc);
+                    }
+                }
+            }
+
+            for (uint32_t out_arc : out[v]) {
+                const uint32_t w = arcs_[out_arc].to;
+                const PathCost via = arcs_[in_arc].cost + arcs_[out_arc].cost;
+                if (w != u && witness.dist[w] > via) {
+                    shortcuts.push_back({u, w, via, kNone, in_arc, out_arc});
+                }
+            }
+            witness.Reset();
+        }
+    };
+
+    // Приоритет вершины: разница рёбер после сжатия плюс число уже сжатых соседей
+    auto priority = [&](uint32_t v, size_t settle_limit) {
+        find_shortcuts(v, settle_limit);
+        return static_cast<int>(shortcuts.size()) - static_cast<int>(in[v].size() + out[v].size())
+               + deleted_neighbors[v];
+    };
+
+    std::vector<double> densities;
+    const size_t sample_step = std::max<size_t>(1, vertex_count / kDensitySampleSize);
+    for (uint32_t v = 0; v < vertex_count; v += sample_step) {
+        find_shortcuts(v, kWitnessSettleLimit);
+        densities.push_back(static_cast<double>(shortcuts.size()) / std::max<size_t>(1, in[v].size() + out[v].size()));
+    }
+    std::nth_element(densities.begin(), densities.begin() + densities.size() / 2, densities.end());
+    const bool has_hierarchy = densities.empty() || densities[densities.size() / 2] <= kCoreDensity;
+
+    std::vector<std::pair<int, uint32_t>> queue;
+    queue.reserve(vertex_count);
+    for (uint32_t v = 0; v < vertex_count; ++v) {
+        queue.emplace_back(has_hierarchy ? priority(v, kEstimateSettleLimit) : 0, v);
+    }
+    std::make_heap(queue.begin(), queue.end(), std::greater<>{});
+
+    // Ленивое обновление: вершина сжимается, если её пересчитанный приоритет
+    // всё ещё не хуже лучшего в очереди
+    rank_.assign(vertex_count, 0);
+    uint32_t next_rank = 0;
+    while (has_hierarchy && !queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<>{});
+        const uint32_t v = queue.back().second;
+        queue.pop_back();
+
+        const int current = priority(v, kWitnessSettleLimit);
+        if (!queue.empty() && current > queue.front().first) {
+            queue.emplace_back(current, v);
+            std::push_heap(queue.begin(), queue.end(), std::greater<>{});
+            continue;
+        }
+        if (shortcuts.size() > kCoreDensity * (in[v].size() + out[v].size())) {
+            queue.emplace_back(current, v);
+            break;
+        }
+
+        for (const Arc& shortcut : shortcuts) {
+            const uint32_t arc = static_cast<uint32_t>(arcs_.size());
+            arcs_.push_back(shortcut);
+            out[shortcut.from].push_back(arc);
+            in[shortcut.to].push_back(arc);
+        }
+        shortcut_count_ += shortcuts.size();
+
+        for (uint32_t arc : in[v]) {
+            ++deleted_neighbors[arcs_[arc].from];
+        }
+        for (uint32_t arc : out[v]) {
+            ++deleted_neighbors[arcs_[arc].to];
+        }
+        contracted[v] = 1;
+        rank_[v] = next_rank++;
+        std::vector<uint32_t>().swap(in[v]);
+        std::vector<uint32_t>().swap(out[v]);
+    }
+
+    // Несжатые вершины образуют ядро с рангами выше всех сжатых
+    core_rank_ = next_rank;
+    for (const auto& [_, v] : queue) {
+        rank_[v] = next_rank++;
+    }
+}
+
+void ContractionHierarchy::BuildSearchGraph(size_t vertex_count) {
+
+    // Дуга внутри ядра нужна обоим поискам: прямому из начала и обратному из конца
+    auto is_up = [this](const Arc& arc) {
+        return rank_[arc.to] > rank_[arc.from] || (rank_[arc.from] >= core_rank_ && rank_[arc.to] >= core_rank_);
+    };
+    auto is_down = [this](const Arc& arc) {
+        return rank_[arc.from] > rank_[arc.to] || (rank_[arc.from] >= core_rank_ && rank_[arc.to] >= core_rank_);
+    };
+
+    up_offsets_.assign(vertex_count + 1, 0);
+    down_offsets_.assign(vertex_count + 1, 0);
+    for (const Arc& arc : arcs_) {
+        up_offsets_[arc.from + 1] += is_up(arc);
+        down_offsets_[arc.to + 1] += is_down(arc);
+    }
+    for (size_t i = 1; i <= vertex_count; ++i) {
+        up_offsets_[i] += up_offsets_[i - 1];
+        down_offsets_[i] += down_offsets_[i - 1];
+    }
+
+    up_arcs_.resize(up_offsets_.back());
+    down_arcs_.resize(down_offsets_.back());
+    std::vector<uint32_t> next_up(up_offsets_.begin(), up_offsets_.end() - 1);
+    std::vector<uint32_t> next_down(down_offsets_.begin(), down_offsets_.end() - 1);
+    for (uint32_t arc = 0; arc < arcs_.size(); ++arc) {
+        if (is_up(arcs_[arc])) {
+            up_arcs_[next_up[arcs_[arc].from]++] = arc;
+        }
+        if (is_down(arcs_[arc])) {
+            down_arcs_[next_down[arcs_[arc].to]++] = arc;
+        }
+    }
+}
+
+bool ContractionHierarchy::FindPath(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const {
+
+    path.clear();
+    if (from == to) {
+        return true;
+    }
+
+    QueryState& state = query_state;
+    const size_t vertex_count = rank_.size();
+    state.forward.Prepare(vertex_count);
+    state.backward.Prepare(vertex_count);
+
+    state.forward.Relax(from, PathCost{}, kNone);
+    state.backward.Relax(to, PathCost{}, kNone);
+
+    PathCost best = kInfiniteCost;
+    uint32_t meeting = kNone;
+
+    // Поиски идут по очереди, каждый только вверх по рангу, а в ядре - по всем его дугам. Направление
+    // останавливается, когда его минимальный ключ не меньше лучшего найденного пути
+    bool forward_turn = true;
+    while (true) {
+        const bool forward_active = state.forward.MinKey() < best;
+        const bool backward_active = state.backward.MinKey() < best;
+        if (!forward_active && !backward_active) {
+            break;
+        }
+        const bool forward = forward_active && (forward_turn || !backward_active);
+        forward_turn = !forward_turn;
+
+        LocalSearch& self = forward ? state.forward : state.backward;
+        const LocalSearch& other = forward ? state.backward : state.forward;
+
+        HeapEntry entry;
+        if (!self.Pop(entry)) {
+            continue;
+        }
+        const auto [distance, vertex] = entry;
+        if (other.dist[vertex] != kInfiniteCost && distance + other.dist[vertex] < best) {
+            best = distance + other.dist[vertex];
+            meeting = vertex;
+        }
+
+        if (forward) {
+            for (uint32_t i = up_offsets_[vertex]; i < up_offsets_[vertex + 1]; ++i) {
+                const Arc& arc = arcs_[up_arcs_[i]];
+                self.Relax(arc.to, distance + arc.cost, up_arcs_[i]);
+            }
+        } else {
+            for (uint32_t i = down_offsets_[vertex]; i < down_offsets_[vertex + 1]; ++i) {
+                const Arc& arc = arcs_[down_arcs_[i]];
+                self.Relax(arc.from, distance + arc.cost, down_arcs_[i]);
+            }
+        }
+    }
+
+    const bool found = meeting != kNone;
+    if (found) {
+        // Дуги от начала до точки встречи, затем от неё до конца
+        state.arcs.clear();
+        for (uint32_t arc = state.forward.parent[meeting]; arc != kNone; arc = state.forward.parent[arcs_[arc].from]) {
+            state.arcs.push_back(arc);
+        }
+        std::reverse(state.arcs.begin(), state.arcs.end());
+        for (uint32_t arc = state.backward.parent[meeting]; arc != kNone; arc = state.backward.parent[arcs_[arc].to]) {
+            state.arcs.push_back(arc);
+        }
+        for (uint32_t arc : state.arcs) {
+            Unpack(arc, path);
+        }
+    }
+
+    state.forward.Reset();
+    state.backward.Reset();
+    return found;
+}
+
+void ContractionHierarchy::Unpack(uint32_t arc, std::vector<uint32_t>& path) const {
+    if (arcs_[arc].edge != kNone) {
+        path.push_back(arcs_[arc].edge);
+        return;
+    }
+    Unpack(arcs_[arc].first, path);
+    Unpack(arcs_[arc].second, path);
+}
+
+size_t ContractionHierarchy::MemoryBytes() const {
+    return arcs_.capacity() * sizeof(Arc)
+           + (rank_.capacity() + up_offsets_.capacity() + up_arcs_.capacity()
+              + down_offsets_.capacity() + down_arcs_.capacity()) * sizeof(uint32_t);
+}
+
+} // namespace router
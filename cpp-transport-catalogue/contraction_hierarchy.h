@@ -0,0 +1,104 @@
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace router {
+
+/**
+ * Вес пути для поиска. Время - целое число долей минуты, поэтому сумма не зависит
+ * от порядка сложения и у сокращения такая же, как у его рёбер по отдельности.
+ * Ключ - сумма псевдослучайных 40-битных ключей рёбер: при равном времени
+ * выбирается путь с меньшим ключом, и кратчайший путь единственный, если суммы
+ * ключей разных путей не совпали (вероятность порядка 2^-40). Поэтому иерархия
+ * сжатий и Дейкстра по таким весам находят один и тот же путь
+ */
+struct PathCost {
+    // Долей в минуте
+    static constexpr double kTimeScale = 4294967296.0;
+
+    int64_t time = 0;
+    uint64_t key = 0;
+
+    PathCost operator+(const PathCost& other) const {
+        return {time + other.time, key + other.key};
+    }
+
+    auto operator<=>(const PathCost&) const = default;
+};
+
+constexpr PathCost kInfiniteCost{INT64_MAX, UINT64_MAX};
+
+/**
+ * Иерархия сжатий (contraction hierarchies) над ориентированным графом
+ * с неотрицательными весами. При построении вершины по очереди «сжимаются»:
+ * если кратчайший путь между соседями вершины проходит через неё, добавляется
+ * ребро-сокращение. Запрос - двунаправленный Дейкстра только вверх по порядку сжатия,
+ * он просматривает малую часть графа. Найденный путь раскрывается в исходные рёбра.
+ *
+ * Если сжатие начинает уплотнять граф (на сетях без иерархии, например случайных),
+ * оставшиеся вершины образуют ядро, внутри которого запрос - обычный двунаправленный
+ * Дейкстра по всем дугам ядра
+ */
+class ContractionHierarchy {
+public:
+    struct InputEdge {
+        uint32_t from;
+        uint32_t to;
+        PathCost cost;
+    };
+
+    ContractionHierarchy(size_t vertex_count, const std::vector<InputEdge>& edges);
+
+    /**
+     * Ищет кратчайший путь и записывает номера исходных рёбер в path по порядку.
+     * Из параллельных рёбер используется самое лёгкое, при равенстве - с меньшим
+     * номером. Возвращает false, если пути нет
+     */
+    bool FindPath(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const;
+
+    size_t ShortcutCount() const {
+        return shortcut_count_;
+    }
+
+    size_t CoreSize() const {
+        return rank_.size() - core_rank_;
+    }
+
+    // Память под структуры запроса, байт
+    size_t MemoryBytes() const;
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    // Дуга иерархии: исходное ребро (edge) или сокращение из дуг first и second
+    struct Arc {
+        uint32_t from;
+        uint32_t to;
+        PathCost cost;
+        uint32_t edge;
+        uint32_t first;
+        uint32_t second;
+    };
+
+    void Contract(size_t vertex_count);
+    void BuildSearchGraph(size_t vertex_count);
+    void Unpack(uint32_t arc, std::vector<uint32_t>& path) const;
+
+    std::vector<Arc> arcs_;
+    std::vector<uint32_t> rank_;
+    // Вершины с рангом от core_rank_ не сжаты и образуют ядро
+    uint32_t core_rank_ = 0;
+    size_t shortcut_count_ = 0;
+
+    // Дуги вверх по рангу, сгруппированные по начальной вершине
+    std::vector<uint32_t> up_offsets_;
+    std::vector<uint32_t> up_arcs_;
+    // Дуги вниз по рангу, сгруппированные по конечной вершине - для обратного поиска
+    std::vector<uint32_t> down_offsets_;
+    std::vector<uint32_t> down_arcs_;
+};
+
+} // namespace router
@@ -0,0 +1,110 @@
+#include "departure_board.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+namespace transport_catalogue {
+
+namespace {
+
+// Прохождение рейса через остановку: через сколько минут после отправления от первой остановки
+struct Visit {
+    StopId stop;
+    double offset;
+};
+
+} // namespace
+
+
+std::optional<uint32_t> ParseClockTime(std::string_view text) {
+
+    const auto colon = text.find(':');
+    if (colon == text.npos || colon == 0 || text.size() - colon != 3) {
+        return std::nullopt;
+    }
+    uint32_t hours = 0;
+    uint32_t minutes = 0;
+    const auto hours_end = text.data() + colon;
+    const auto [hours_ptr, hours_ec] = std::from_chars(text.data(), hours_end, hours);
+    const auto [minutes_ptr, minutes_ec] = std::from_chars(hours_end + 1, text.data() + text.size(), minutes);
+    if (hours_ec != std::errc() || hours_ptr != hours_end || minutes_ec != std::errc()
+        || minutes_ptr != text.data() + text.size() || minutes > 59 || hours >= kMaxClockHours) {
+        return std::nullopt;
+    }
+    return hours * 60 + minutes;
+}
+
+DepartureBoard::DepartureBoard(const CatalogueView& catalogue, const std::vector<TripSchedule>& schedules,
+                               double bus_velocity) {
+
+    const double meters_per_minute = bus_velocity * 1000 / 60;
+
+    // Рейсы маршрута могут быть заданы несколькими расписаниями
+    std::vector<std::vector<uint32_t>> trips(catalogue.BusCount());
+    for (const TripSchedule& schedule : schedules) {
+        if (const auto bus = catalogue.GetBus(schedule.bus)) {
+            trips[*bus].insert(trips[*bus].end(), schedule.departures.begin(), schedule.departures.end());
+        }
+    }
+
+    // Прохождения остановок упорядочены по остановке, повторные - по порядку на маршруте
+    std::vector<std::vector<Visit>> visits(catalogue.BusCount());
+    for (BusId bus = 0; bus < catalogue.BusCount(); ++bus) {
+        if (trips[bus].empty()) {
+            continue;
+        }
+        std::sort(trips[bus].begin(), trips[bus].end());
+
+        const auto route = catalogue.GetBusStops(bus);
+        const std::vector<StopId> stops(route.begin(), route.end());
+        double offset = 0;
+        for (size_t i = 0; i + 1 < stops.size(); ++i) {
+            visits[bus].push_back({stops[i], offset});
+            offset += catalogue.GetSegmentLength(stops[i], stops[i + 1]) / meters_per_minute;
+        }
+        std::stable_sort(visits[bus].begin(), visits[bus].end(), [](const Visit& lhs, const Visit& rhs) {
+            return lhs.stop < rhs.stop;
+        });
+    }
+
+    // Автобусы остановки упорядочены по названию, поэтому после устойчивой
+    // сортировки по времени одновременные отправления идут по названию маршрута
+    stop_offsets_.reserve(catalogue.StopCount() + 1);
+    stop_offsets_.push_back(0);
+    for (StopId stop = 0; stop < catalogue.StopCount(); ++stop) {
+        const size_t row_begin = departures_.size();
+        for (const BusId bus : catalogue.GetBusesForStop(stop)) {
+            const auto [first, last] = std::equal_range(visits[bus].begin(), visits[bus].end(), Visit{stop, 0},
+                                                        [](const Visit& lhs, const Visit& rhs) {
+                                                            return lhs.stop < rhs.stop;
+                                                        });
+            for (auto visit = first; visit != last; ++visit) {
+                for (const uint32_t departure : trips[bus]) {
+                    departures_.push_back({static_cast<uint32_t>(std::lround(departure + visit->offset)), bus});
+                }
+            }
+        }
+        std::stable_sort(departures_.begin() + row_begin, departures_.end(),
+                         [](const Departure& lhs, const Departure& rhs) {
+                             return lhs.time < rhs.time;
+                         });
+        if (departures_.size() > UINT32_MAX) {
+            throw std::length_error("Departure board exceeds 2^32 departures");
+        }
+        stop_offsets_.push_back(static_cast<uint32_t>(departures_.size()));
+    }
+    departures_.shrink_to_fit();
+}
+
+std::span<const Departure> DepartureBoard::FindDepartures(StopId stop, uint32_t time, size_t count) const {
+
+    const auto row_begin = departures_.begin() + stop_offsets_[stop];
+    const auto row_end = departures_.begin() + stop_offsets_[stop + 1];
+    const auto first = std::partition_point(row_begin, row_end, [time](const Departure& departure) {
+        return departure.time < time;
+    });
+    return {first, std::min<size_t>(count, row_end - first)};
+}
+
+} // namespace transport_catalogue
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "transport_catalogue.h"
+
+
+namespace transport_catalogue {
+
+// Часы времени меньше этого значения: двое суток покрывают ночные рейсы
+constexpr uint32_t kMaxClockHours = 48;
+
+/**
+ * Время "ЧЧ:ММ" в минутах от полуночи. Рейсы после полуночи продолжают
+ * счёт тех же суток, поэтому часы могут быть больше 23 ("24:10" - 1450),
+ * но не меньше kMaxClockHours - иначе nullopt
+ */
+std::optional<uint32_t> ParseClockTime(std::string_view text);
+
+/**
+ * Расписание маршрута: времена отправления рейсов от первой остановки,
+ * минуты от полуночи. Рейс проходит все остановки маршрута, у некольцевого -
+ * туда и обратно
+ */
+struct TripSchedule {
+    std::string bus;
+    std::vector<uint32_t> departures;
+};
+
+struct Departure {
+    uint32_t time;  // минуты от полуночи
+    BusId bus;
+};
+
+/**
+ * Табло отправлений всех остановок. Время прибытия рейса на остановку считается
+ * по длинам перегонов (GetSegmentLength, как у TransportRouter) и скорости
+ * автобуса и округляется до минуты; с последней остановки маршрута рейс
+ * не отправляется.
+ *
+ * Отправления остановки i занимают [stop_offsets_[i], stop_offsets_[i + 1]) в
+ * departures_ и упорядочены по времени, при равном времени - по названию маршрута.
+ * Запрос - двоичный поиск по времени, ответ - часть этого массива без копирования.
+ * Память - одна запись на каждое прохождение каждого рейса через остановку
+ */
+class DepartureBoard {
+public:
+    // Расписания неизвестных маршрутов пропускаются; bus_velocity - км/ч
+    DepartureBoard(const CatalogueView& catalogue, const std::vector<TripSchedule>& schedules, double bus_velocity);
+
+    // Не больше count ближайших отправлений с остановки stop не раньше time
+    std::span<const Departure> FindDepartures(StopId stop, uint32_t time, size_t count) const;
+
+    size_t DepartureCount() const {
+        return departures_.size();
+    }
+
+private:
+    std::vector<uint32_t> stop_offsets_;
+    std::vector<Departure> departures_;
+};
+
+} // namespace transport_catalogue
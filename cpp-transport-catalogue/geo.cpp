@@ -0,0 +1,108 @@
+#include "geo.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace geo {
+
+namespace {
+
+/**
+ * Косинус центрального угла sin(a) * sin(b) + cos(a) * cos(b) * cos(dlng) для отрезков
+ * с begin по count; на входе distances[i] - косинус разницы долгот.
+ * Векторные версии обрабатывают целые блоки и возвращают номер первого необработанного отрезка,
+ * операции в них те же и в том же порядке, что в скалярной
+ */
+void CosCentralAngleScalar(const PointTable& points, std::span<const uint32_t> path, std::span<double> distances,
+                           size_t begin, size_t count) {
+    for (size_t i = begin; i < count; ++i) {
+        const uint32_t from = path[i];
+        const uint32_t to = path[i + 1];
+        distances[i] = points.sin_lat[from] * points.sin_lat[to]
+                       + points.cos_lat[from] * points.cos_lat[to] * distances[i];
+    }
+}
+
+#if defined(__x86_64__)
+
+// SSE2 есть на любом x86-64: по два отрезка, значения из таблицы собираются поштучно
+size_t CosCentralAngleSse2(const PointTable& points, std::span<const uint32_t> path, std::span<double> distances,
+                           size_t count) {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const uint32_t p0 = path[i];
+        const uint32_t p1 = path[i + 1];
+        const uint32_t p2 = path[i + 2];
+
+        const __m128d sin_product = _mm_mul_pd(_mm_set_pd(points.sin_lat[p1], points.sin_lat[p0]),
+                                               _mm_set_pd(points.sin_lat[p2], points.sin_lat[p1]));
+        const __m128d cos_product = _mm_mul_pd(_mm_set_pd(points.cos_lat[p1], points.cos_lat[p0]),
+                                               _mm_set_pd(points.cos_lat[p2], points.cos_lat[p1]));
+        const __m128d cos_dlng = _mm_loadu_pd(distances.data() + i);
+
+        _mm_storeu_pd(distances.data() + i, _mm_add_pd(sin_product, _mm_mul_pd(cos_product, cos_dlng)));
+    }
+    return i;
+}
+
+// Четыре значения table по индексам; вариант с маской, чтобы GCC не ругался на неинициализированный приёмник
+__attribute__((target("avx2")))
+__m256d Gather(const double* table, __m128i indexes) {
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), table, indexes, all, 8);
+}
+
+// Собирается под AVX2 независимо от флагов сборки, вызывается только если процессор его поддерживает
+__attribute__((target("avx2")))
+size_t CosCentralAngleAvx2(const PointTable& points, std::span<const uint32_t> path, std::span<double> distances,
+                           size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i from = _mm_loadu_si128(reinterpret_cast<const __m128i*>(path.data() + i));
+        const __m128i to = _mm_loadu_si128(reinterpret_cast<const __m128i*>(path.data() + i + 1));
+
+        const __m256d sin_product = _mm256_mul_pd(Gather(points.sin_lat, from), Gather(points.sin_lat, to));
+        const __m256d cos_product = _mm256_mul_pd(Gather(points.cos_lat, from), Gather(points.cos_lat, to));
+        const __m256d cos_dlng = _mm256_loadu_pd(distances.data() + i);
+
+        _mm256_storeu_pd(distances.data() + i, _mm256_add_pd(sin_product, _mm256_mul_pd(cos_product, cos_dlng)));
+    }
+    return i;
+}
+
+#endif
+
+} // namespace
+
+void ComputePathDistances(const PointTable& points, std::span<const uint32_t> path, std::span<double> distances) {
+    using namespace std;
+
+    if (path.size() < 2) {
+        return;
+    }
+    const size_t count = path.size() - 1;
+
+    // Косинус разницы долгот - единственная тригонометрия, зависящая от пары точек
+    for (size_t i = 0; i < count; ++i) {
+        distances[i] = cos(abs(points.coordinates[path[i]].lng - points.coordinates[path[i + 1]].lng) * kDegToRad);
+    }
+
+    size_t vectorized = 0;
+#if defined(__x86_64__)
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    vectorized = has_avx2 ? CosCentralAngleAvx2(points, path, distances, count)
+                          : CosCentralAngleSse2(points, path, distances, count);
+#endif
+    CosCentralAngleScalar(points, path, distances, vectorized, count);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (points.coordinates[path[i]] == points.coordinates[path[i + 1]]) {
+            distances[i] = 0;
+        } else {
+            distances[i] = acos(distances[i]) * kEarthRadius;
+        }
+    }
+}
+
+} //geo
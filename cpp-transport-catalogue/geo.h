@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
+#include <span>
 
 namespace geo {
 
@@ -15,15 +17,43 @@ struct Coordinates {
     }
 };
 
+inline constexpr double kDegToRad = 3.1415926535 / 180.;
+inline constexpr double kEarthRadius = 6371000;
+
 inline double ComputeDistance(Coordinates from, Coordinates to) {
     using namespace std;
     if (from == to) {
         return 0;
     }
-    static const double dr = 3.1415926535 / 180.;
+    static const double dr = kDegToRad;
     return acos(sin(from.lat * dr) * sin(to.lat * dr)
                 + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
-        * 6371000;
+        * kEarthRadius;
 }
 
+/**
+ * Таблица точек с заранее посчитанными синусом и косинусом широты.
+ * Все массивы индексируются номером точки
+ */
+struct PointTable {
+    const Coordinates* coordinates;
+    const double* sin_lat;
+    const double* cos_lat;
+};
+
+/**
+ * Считает расстояния между соседними точками пути: distances[i] - от path[i] до path[i + 1],
+ * размер distances должен быть не меньше path.size() - 1.
+ * Формула та же, что в ComputeDistance, но синусы и косинусы широт берутся из таблицы,
+ * а скалярное произведение считается векторно. Путь выбирается при первом вызове
+ * по процессору, а не по флагам сборки: на x86-64 - AVX2 со сбором из таблицы, если
+ * процессор его поддерживает, иначе SSE2; на других архитектурах - скалярный цикл.
+ * cos и acos остаются скалярными вызовами libm.
+ * Проект собирается с -ffp-contract=off (QMAKE_CXXFLAGS в .pro), поэтому результат
+ * побитово совпадает с ComputeDistance. Если сжатие в FMA всё же включено, оценка
+ * только абсолютная: ошибка косинуса в несколько ulp (δ ~ 1e-16) сдвигает угол на δ / sin(угла),
+ * а у коротких отрезков, где acos теряет точность у единицы, - до sqrt(2δ) ~ 2e-8 рад, то есть ~0.1 м
+ */
+void ComputePathDistances(const PointTable& points, std::span<const uint32_t> path, std::span<double> distances);
+
 } //geo
@@ -1,47 +1,218 @@
 #include "input_reader.h"
 #include <cassert>
+#include <charconv>
 #include <iterator>
 #include <algorithm>
-#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "command_table.h"
 #include "geo.h"
+#include "metrics.h"
+#include "parallel.h"
 
 namespace input {
 
 
-std::vector<std::pair<int, std::string>> ParseStopDistances(const std::string& input) {
+InputBuffer InputBuffer::FromDescriptor(int fd) {
+    InputBuffer buffer;
 
-    using namespace std;
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, st.st_size, MADV_SEQUENTIAL);
+            buffer.mapped_ = data;
+            buffer.mapped_size_ = st.st_size;
+            buffer.text_ = {static_cast<const char*>(data), buffer.mapped_size_};
+            return buffer;
+        }
+    }
+
+    // Канал или терминал: читаем крупными блоками до конца
+    char chunk[1 << 16];
+    ssize_t read_count;
+    while ((read_count = read(fd, chunk, sizeof(chunk))) > 0) {
+        buffer.owned_.append(chunk, read_count);
+    }
+    buffer.text_ = buffer.owned_;
+    return buffer;
+}
+
+InputBuffer::InputBuffer(InputBuffer&& other) noexcept
+    : owned_(std::move(other.owned_))
+    , mapped_(other.mapped_)
+    , mapped_size_(other.mapped_size_)
+    , pos_(other.pos_) {
+
+    text_ = mapped_ ? other.text_ : std::string_view(owned_);
+    other.mapped_ = nullptr;
+    other.mapped_size_ = 0;
+    other.text_ = {};
+    other.pos_ = 0;
+}
+
+InputBuffer InputBuffer::FromString(std::string text) {
+    InputBuffer buffer;
+    buffer.owned_ = std::move(text);
+    buffer.text_ = buffer.owned_;
+    return buffer;
+}
+
+InputBuffer::~InputBuffer() {
+    if (mapped_) {
+        munmap(mapped_, mapped_size_);
+    }
+}
+
+std::string_view InputBuffer::GetLine() {
+    if (AtEnd()) {
+        return {};
+    }
+
+    auto end = text_.find('\n', pos_);
+    if (end == text_.npos) {
+        end = text_.size();
+    }
+
+    auto line = text_.substr(pos_, end - pos_);
+    pos_ = end + 1;
+
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+bool LineStream::Fill() {
+    if (eof_) {
+        return false;
+    }
+
+    // Прочитанные строки отбрасываются, чтобы буфер не рос вместе с вводом
+    buffer_.erase(0, pos_);
+    pos_ = 0;
+
+    constexpr size_t kBlockSize = 1 << 16;
+    const size_t size = buffer_.size();
+    buffer_.resize(size + kBlockSize);
+    const ssize_t read_count = read(fd_, buffer_.data() + size, kBlockSize);
+    buffer_.resize(size + std::max<ssize_t>(read_count, 0));
+    if (read_count <= 0) {
+        eof_ = true;
+        return false;
+    }
+    return true;
+}
+
+bool LineStream::AtEnd() {
+    return pos_ >= buffer_.size() && !Fill();
+}
+
+std::string_view LineStream::GetLine() {
+    size_t end;
+    while ((end = buffer_.find('\n', pos_)) == buffer_.npos && Fill()) {
+    }
+    if (pos_ >= buffer_.size()) {
+        return {};
+    }
+    if (end == buffer_.npos) {
+        end = buffer_.size();
+    }
+
+    std::string_view line(buffer_.data() + pos_, end - pos_);
+    pos_ = end + 1;
+
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+InputBuffer LineStream::TakeRest() {
+    buffer_.erase(0, pos_);
+    pos_ = 0;
+    while (Fill()) {
+    }
+    return InputBuffer::FromString(std::exchange(buffer_, {}));
+}
 
-    vector<pair<int, string>> result;
+template <typename Input>
+int ReadRequestCountFrom(Input& input) {
+    while (!input.AtEnd()) {
+        auto line = input.GetLine();
+        auto start = line.find_first_not_of(" \t");
+        if (start == line.npos) {
+            continue;
+        }
+
+        int count = 0;
+        auto [ptr, ec] = std::from_chars(line.data() + start, line.data() + line.size(), count);
+        if (ec != std::errc()) {
+            throw std::invalid_argument("Invalid request count");
+        }
+        return count;
+    }
+    return 0;
+}
+
+int ReadRequestCount(InputBuffer& input) {
+    return ReadRequestCountFrom(input);
+}
+
+int ReadRequestCount(LineStream& input) {
+    return ReadRequestCountFrom(input);
+}
+
+/**
+ * Удаляет пробелы и табуляции в начале и конце строки
+ */
+std::string_view TrimBlank(std::string_view string) {
+    const auto start = string.find_first_not_of(" \t");
+    if (start == string.npos) {
+        return {};
+    }
+    return string.substr(start, string.find_last_not_of(" \t") + 1 - start);
+}
+
+/**
+ * Парсит список расстояний вида "D1m to stop1, D2m to stop2" после координат
+ * и дописывает их в result
+ */
+void ParseStopDistances(std::string_view input, std::vector<StopDistance>& result) {
+    METRICS_TIMER("parse_stop_distances");
+
+    using namespace std;
 
     // Находим начало списка расстояний (после координат)
     size_t dist_pos = input.find(',', input.find(',') + 1);
-    if (dist_pos == string::npos) {
-        return result; // Нет расстояний
+    if (dist_pos == string_view::npos) {
+        return; // Нет расстояний
     }
 
-    string distances_str = input.substr(dist_pos);
-    std::istringstream iss(distances_str);
-    string token;
-
-    while (getline(iss, token, ',')) {
-        // Удаляем начальные и конечные пробелы
-        token.erase(0, token.find_first_not_of(" \t"));
-        token.erase(token.find_last_not_of(" \t") + 1);
+    while (dist_pos < input.size()) {
+        size_t next = input.find(',', dist_pos + 1);
+        if (next == string_view::npos) {
+            next = input.size();
+        }
+        const string_view token = TrimBlank(input.substr(dist_pos + 1, next - dist_pos - 1));
+        dist_pos = next;
 
         if (token.empty()) continue;
 
         // Парсим расстояние
         size_t m_pos = token.find('m');
-        if (m_pos == string::npos) {
+        if (m_pos == string_view::npos) {
             throw invalid_argument("Invalid distance format - missing 'm'");
         }
 
-        string dist_str = token.substr(0, m_pos);
-        int distance;
-        try {
-            distance = stoi(dist_str);
-        } catch (...) {
+        const string_view dist_str = TrimBlank(token.substr(0, m_pos));
+        int distance = 0;
+        auto [ptr, ec] = from_chars(dist_str.data(), dist_str.data() + dist_str.size(), distance);
+        if (ec != errc() || ptr == dist_str.data()) {
             throw invalid_argument("Invalid distance value");
         }
 
@@ -51,23 +222,35 @@ std::vector<std::pair<int, std::string>> ParseStopDistances(const std::string& i
 
         // Парсим название остановки
         size_t to_pos = token.find("to ", m_pos);
-        if (to_pos == string::npos) {
+        if (to_pos == string_view::npos) {
             throw invalid_argument("Invalid format - missing 'to'");
         }
 
-        string stop_name = token.substr(to_pos + 3);
-        stop_name.erase(0, stop_name.find_first_not_of(" \t"));
-        stop_name.erase(stop_name.find_last_not_of(" \t") + 1);
+        const string_view stop_name = TrimBlank(token.substr(to_pos + 3));
 
         if (stop_name.empty()) {
             throw invalid_argument("Empty stop name");
         }
 
-        result.emplace_back(distance, stop_name);
+        result.push_back({distance, stop_name});
     }
+}
 
+/**
+ * Разбирает вещественное число в начале строки без выделения памяти
+ */
+double ParseDouble(std::string_view str) {
+    str = TrimBlank(str);
+    if (!str.empty() && str.front() == '+') {
+        str.remove_prefix(1);
+    }
 
-    return result;
+    double value = 0.;
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc()) {
+        throw std::invalid_argument("Invalid coordinate value");
+    }
+    return value;
 }
 
 /**
@@ -76,17 +259,14 @@ std::vector<std::pair<int, std::string>> ParseStopDistances(const std::string& i
 geo::Coordinates ParseCoordinates(std::string_view str) {
     static const double nan = std::nan("");
 
-    auto not_space = str.find_first_not_of(' ');
     auto comma = str.find(',');
 
     if (comma == str.npos) {
         return {nan, nan};
     }
 
-    auto not_space2 = str.find_first_not_of(' ', comma + 1);
-
-    double lat = std::stod(std::string(str.substr(not_space, comma - not_space)));
-    double lng = std::stod(std::string(str.substr(not_space2)));
+    double lat = ParseDouble(str.substr(0, comma));
+    double lng = ParseDouble(str.substr(comma + 1));
 
     return {lat, lng};
 }
@@ -103,11 +283,10 @@ std::string_view Trim(std::string_view string) {
 }
 
 /**
- * Разбивает строку string на n строк, с помощью указанного символа-разделителя delim
+ * Разбивает строку string на n строк, с помощью указанного символа-разделителя delim,
+ * и дописывает их в result
  */
-std::vector<std::string_view> Split(std::string_view string, char delim) {
-    std::vector<std::string_view> result;
-
+void Split(std::string_view string, char delim, std::vector<std::string_view>& result) {
     size_t pos = 0;
     while ((pos = string.find_first_not_of(' ', pos)) < string.length()) {
         auto delim_pos = string.find(delim, pos);
@@ -119,28 +298,75 @@ std::vector<std::string_view> Split(std::string_view string, char delim) {
         }
         pos = delim_pos + 1;
     }
-
-    return result;
 }
 
 /**
- * Парсит маршрут.
- * Для кольцевого маршрута (A>B>C>A) возвращает массив названий остановок [A,B,C,A]
- * Для некольцевого маршрута (A-B-C-D) возвращает массив названий остановок [A,B,C,D,C,B,A]
+ * Парсит маршрут в stops, прежнее содержимое stops заменяется.
+ * Для кольцевого маршрута (A>B>C>A) даёт массив названий остановок [A,B,C,A]
+ * Для некольцевого маршрута (A-B-C-D) даёт массив названий остановок [A,B,C,D,C,B,A]
  */
-std::vector<std::string_view> ParseRoute(std::string_view route) {
+void ParseRoute(std::string_view route, std::vector<std::string_view>& stops) {
+    stops.clear();
     if (route.find('>') != route.npos) {
-        return Split(route, '>');
+        Split(route, '>', stops);
+        return;
     }
 
-    auto stops = Split(route, '-');
-    std::vector<std::string_view> results(stops.begin(), stops.end());
-    results.insert(results.end(), std::next(stops.rbegin()), stops.rend());
+    Split(route, '-', stops);
+    const size_t forward = stops.size();
+    for (size_t i = forward; i > 1; --i) {
+        stops.push_back(stops[i - 2]);
+    }
+}
+
+/**
+ * Разбирает расписание маршрута: список отправлений "06:00, 06:15, 07:40" или
+ * интервал "06:00 to 23:00 every 10" - рейсы каждые 10 минут с 06:00 не позже 23:00
+ */
+transport_catalogue::TripSchedule ParseTimetable(std::string_view bus, std::string_view description) {
+    using transport_catalogue::ParseClockTime;
 
-    return results;
+    transport_catalogue::TripSchedule schedule{std::string(bus), {}};
+    description = TrimBlank(description);
+
+    if (const auto every_pos = description.find(" every "); every_pos != description.npos) {
+        const auto to_pos = description.find(" to ");
+        if (to_pos >= every_pos) {
+            throw std::invalid_argument("Invalid timetable interval - missing 'to'");
+        }
+        const auto first = ParseClockTime(TrimBlank(description.substr(0, to_pos)));
+        const auto last = ParseClockTime(TrimBlank(description.substr(to_pos + 4, every_pos - to_pos - 4)));
+        const std::string_view headway_text = TrimBlank(description.substr(every_pos + 7));
+        uint32_t headway = 0;
+        const auto [ptr, ec] = std::from_chars(headway_text.data(), headway_text.data() + headway_text.size(), headway);
+        if (!first || !last || ec != std::errc() || ptr != headway_text.data() + headway_text.size() || headway == 0) {
+            throw std::invalid_argument("Invalid timetable interval");
+        }
+        // Времена ограничены kMaxClockHours, поэтому рейсов не больше 48 * 60,
+        // а шаг не выводит время за last и не переполняет его
+        for (uint32_t time = *first; time <= *last; time += headway) {
+            schedule.departures.push_back(time);
+            if (*last - time < headway) {
+                break;
+            }
+        }
+        return schedule;
+    }
+
+    std::vector<std::string_view> times;
+    Split(description, ',', times);
+    for (const std::string_view text : times) {
+        const auto time = ParseClockTime(text);
+        if (!time) {
+            throw std::invalid_argument("Invalid timetable time");
+        }
+        schedule.departures.push_back(*time);
+    }
+    return schedule;
 }
 
 input::CommandDescription ParseCommandDescription(std::string_view line) {
+    METRICS_TIMER("parse_command_description");
     auto colon_pos = line.find(':');
     if (colon_pos == line.npos) {
         return {};
@@ -156,73 +382,343 @@ input::CommandDescription ParseCommandDescription(std::string_view line) {
         return {};
     }
 
-    return {std::string(line.substr(0, space_pos)),
-            std::string(line.substr(not_space, colon_pos - not_space)),
-            std::string(line.substr(colon_pos + 1))};
+    return {line.substr(0, space_pos),
+            line.substr(not_space, colon_pos - not_space),
+            line.substr(colon_pos + 1)};
 }
 
-void input::Reader::ParseLine(std::string_view line) {
-    auto command_description = ParseCommandDescription(line);
-    if (command_description) {
-        commands_.push_back(std::move(command_description));
+// Команды запросов на заполнение, номер команды - её индекс в таблице
+enum BaseCommand : size_t {
+    kStopCommand,
+    kBusCommand,
+    kTimetableCommand,
+};
+
+constexpr dispatch::CommandTable<3> kBaseCommands({"Stop", "Bus", "Timetable"});
+
+void input::Reader::Commands::Parse(std::string_view line) {
+    auto command = ParseCommandDescription(line);
+    if (!command) {
+        return;
+    }
+
+    switch (kBaseCommands.Find(command.command)) {
+    case kStopCommand: {
+        const size_t distances_begin = distances.size();
+        ParseStopDistances(command.description, distances);
+        stops.push_back({command.id, ParseCoordinates(command.description),
+                         distances_begin, distances.size()});
+        break;
+    }
+    case kBusCommand:
+        buses.push_back({command.id, command.description});
+        break;
+    case kTimetableCommand:
+        schedules.push_back(ParseTimetable(command.id, command.description));
+        break;
     }
 }
 
+void input::Reader::Commands::Append(Commands&& other) {
+    const size_t shift = distances.size();
+    for (auto& stop : other.stops) {
+        stop.distances_begin += shift;
+        stop.distances_end += shift;
+    }
 
-void input::Reader::ApplyCommands(transport_catalogue::TransportCatalogue& catalogue)  {
+    stops.insert(stops.end(), other.stops.begin(), other.stops.end());
+    buses.insert(buses.end(), other.buses.begin(), other.buses.end());
+    distances.insert(distances.end(), other.distances.begin(), other.distances.end());
+    schedules.insert(schedules.end(), std::make_move_iterator(other.schedules.begin()),
+                     std::make_move_iterator(other.schedules.end()));
+}
+
+void input::Reader::ParseLine(std::string_view line) {
+    commands_.Parse(line);
+}
+
+void input::Reader::ParseLines(const std::vector<std::string_view>& lines, unsigned thread_count) {
 
-    std::ranges::partition(commands_, [](CommandDescription const& cmd)
-                    {
-                            return cmd.command.starts_with("Stop");
-                    });
+    std::vector<Commands> chunks(std::max(thread_count, 1u));
+    parallel::ForEachChunk(lines.size(), thread_count, [&](size_t begin, size_t end, unsigned chunk) {
+        for (size_t i = begin; i < end; ++i) {
+            chunks[chunk].Parse(lines[i]);
+        }
+    });
 
+    // Куски склеиваются по порядку, так что порядок команд как при последовательном разборе
+    for (auto& chunk : chunks) {
+        commands_.Append(std::move(chunk));
+    }
+}
 
-    for (const auto& command : commands_) {
-        if (command.command == "Stop") {
-            auto coords = ParseCoordinates(command.description);
-            catalogue.AddStop(command.id, coords);
 
-        } else if (command.command == "Bus") {
-            auto stops = ParseRoute(command.description);
-            bool is_roundtrip = command.description.find('>') != std::string::npos;
+void input::Reader::ApplyCommands(transport_catalogue::TransportCatalogue& catalogue, unsigned thread_count)  {
+    METRICS_TIMER("apply_commands");
 
-            std::vector<std::string> stop_names;
-            stop_names.reserve(stops.size());
-            for (auto stop : stops) {
-                stop_names.emplace_back(stop);
-            }
+    using transport_catalogue::StopId;
 
-            catalogue.AddBus(command.id, std::move(stop_names), is_roundtrip);
-        }
+    const auto& [stops, buses, distances, schedules] = commands_;
+
+    // Сначала все остановки, чтобы маршруты и расстояния могли на них ссылаться.
+    // Регистрация имён последовательная, она определяет StopId
+    for (const auto& stop : stops) {
+        catalogue.AddStop(stop.name, stop.coordinates);
     }
 
-    for (const auto& command : commands_) {
-        if (command.command == "Stop"){
-            auto result = ParseStopDistances(command.description);
-            // catalogue.AddDistance (command.id, result);
+    // Дальше справочник только читается: каждый поток разрешает имена своих
+    // маршрутов и расстояний в собственные буферы
+    struct ResolvedChunk {
+        std::vector<StopId> route_stops;
+        std::vector<size_t> route_ends;      // конец остановок i-го маршрута куска в route_stops
+        std::vector<std::tuple<StopId, StopId, int>> distances;
+    };
+
+    const unsigned chunk_count = std::max(thread_count, 1u);
+    std::vector<ResolvedChunk> bus_chunks(chunk_count);
+    parallel::ForEachChunk(buses.size(), thread_count, [&](size_t begin, size_t end, unsigned chunk) {
+        auto& resolved = bus_chunks[chunk];
+        // Буфер названий переиспользуется всеми маршрутами куска
+        std::vector<std::string_view> stop_names;
+        for (size_t i = begin; i < end; ++i) {
+            ParseRoute(buses[i].route, stop_names);
+            for (auto stop_name : stop_names) {
+                if (auto stop = catalogue.GetStop(stop_name)) {
+                    resolved.route_stops.push_back(*stop);
+                }
+            }
+            resolved.route_ends.push_back(resolved.route_stops.size());
+        }
+    });
 
-            const transport_catalogue::Stop* from_stop = catalogue.GetStop(command.id);
+    std::vector<ResolvedChunk> distance_chunks(chunk_count);
+    parallel::ForEachChunk(stops.size(), thread_count, [&](size_t begin, size_t end, unsigned chunk) {
+        auto& resolved = distance_chunks[chunk];
+        for (size_t i = begin; i < end; ++i) {
+            const auto from_stop = catalogue.GetStop(stops[i].name);
 
             if (!from_stop)
             {
                 continue; // Остановка не найдена
             }
 
-            // Добавляем все расстояния из вектора
-            for (const auto& [distance, to_stop_name] : result) {
+            // Добавляем все расстояния остановки
+            for (size_t j = stops[i].distances_begin; j < stops[i].distances_end; ++j) {
 
-                const transport_catalogue::Stop* to_stop = catalogue.GetStop(to_stop_name);
+                const auto to_stop = catalogue.GetStop(distances[j].to);
                 if (!to_stop)
                 {
                     continue;
                 }
 
-                catalogue.SetDistance( from_stop ,  to_stop , distance );
+                resolved.distances.emplace_back(*from_stop, *to_stop, distances[j].meters);
+            }
+        }
+    });
+
+    // Слияние в исходном порядке команд
+    size_t bus_index = 0;
+    for (const auto& resolved : bus_chunks) {
+        size_t route_begin = 0;
+        for (size_t route_end : resolved.route_ends) {
+            const auto& bus = buses[bus_index++];
+            const bool is_roundtrip = bus.route.find('>') != std::string_view::npos;
+            const std::span<const StopId> route(resolved.route_stops.data() + route_begin, route_end - route_begin);
+
+            catalogue.AddBus(bus.name, route, is_roundtrip);
+            route_begin = route_end;
+        }
+    }
+
+    for (const auto& resolved : distance_chunks) {
+        for (const auto& [from_stop, to_stop, meters] : resolved.distances) {
+            catalogue.SetDistance( from_stop ,  to_stop , meters );
+        }
+    }
+
+    catalogue.BuildIndexes(thread_count);
+}
 
+std::vector<transport_catalogue::TripSchedule> input::Reader::TakeSchedules() {
+    return std::move(commands_.schedules);
+}
 
-            }
+
+void input::StreamingReader::ApplyLine(std::string_view line) {
+    const auto command = ParseCommandDescription(line);
+    if (!command) {
+        return;
+    }
+
+    switch (kBaseCommands.Find(command.command)) {
+    case kStopCommand:
+        ApplyStop(command.id, command.description);
+        break;
+    case kBusCommand:
+        ApplyBus(command.id, command.description);
+        break;
+    case kTimetableCommand:
+        schedules_.push_back(ParseTimetable(command.id, command.description));
+        break;
+    }
+}
+
+void input::StreamingReader::ApplyStop(std::string_view name, std::string_view description) {
+    distances_.clear();
+    ParseStopDistances(description, distances_);
+    const StopId stop = catalogue_.AddStop(name, ParseCoordinates(description));
+
+    ResolveWaiters(name, stop);
+
+    for (const auto& [meters, to] : distances_) {
+        if (const auto to_stop = catalogue_.GetStop(to)) {
+            catalogue_.SetDistance(stop, *to_stop, meters);
+        } else {
+            METRICS_COUNT("streaming_deferred_distances", 1);
+            AddWaiter(InternUnknown(to), stop, meters);
+        }
+    }
+}
+
+void input::StreamingReader::ApplyBus(std::string_view name, std::string_view route) {
+    const bool is_roundtrip = route.find('>') != std::string_view::npos;
+    ParseRoute(route, stop_names_);
+
+    // Обычно все остановки уже известны, и маршрут добавляется сразу
+    route_.clear();
+    for (auto stop_name : stop_names_) {
+        const auto stop = catalogue_.GetStop(stop_name);
+        if (!stop) {
+            break;
+        }
+        route_.push_back(*stop);
+    }
+    if (route_.size() == stop_names_.size()) {
+        catalogue_.AddBus(name, route_, is_roundtrip);
+        return;
+    }
+
+    METRICS_COUNT("streaming_deferred_buses", 1);
+    uint32_t index = static_cast<uint32_t>(pending_buses_.size());
+    if (free_pending_buses_.empty()) {
+        pending_buses_.emplace_back();
+    } else {
+        index = free_pending_buses_.back();
+        free_pending_buses_.pop_back();
+    }
+    ++pending_bus_count_;
+
+    auto& bus = pending_buses_[index];
+    bus.name = name;
+    bus.is_roundtrip = is_roundtrip;
+    bus.route.reserve(stop_names_.size());
+    bus.route.assign(route_.begin(), route_.end());
+    for (size_t i = route_.size(); i < stop_names_.size(); ++i) {
+        if (const auto stop = catalogue_.GetStop(stop_names_[i])) {
+            bus.route.push_back(*stop);
+            continue;
+        }
+
+        const uint32_t name_id = InternUnknown(stop_names_[i]);
+        // Повторы одного имени в маршруте ждут остановку одним звеном
+        const uint32_t last = unknown_[name_id].last_waiter;
+        if (last == kNone || waiters_[last].meters != 0 || waiters_[last].source != index) {
+            AddWaiter(name_id, index, 0);
+            ++bus.unresolved_names;
+        }
+        bus.route.push_back(kUnresolvedBit | name_id);
+    }
+}
+
+uint32_t input::StreamingReader::InternUnknown(std::string_view name) {
+    const uint32_t name_id = unknown_names_.Intern(name);
+    if (unknown_.size() <= name_id) {
+        unknown_.resize(name_id + 1);
+    }
+    return name_id;
+}
+
+void input::StreamingReader::AddWaiter(uint32_t name_id, uint32_t source, int meters) {
+    uint32_t waiter = free_waiter_;
+    if (waiter == kNone) {
+        waiter = static_cast<uint32_t>(waiters_.size());
+        waiters_.push_back({});
+    } else {
+        free_waiter_ = waiters_[waiter].next;
+    }
+    waiters_[waiter] = {kNone, source, meters};
+
+    auto& unknown = unknown_[name_id];
+    if (unknown.last_waiter == kNone) {
+        unknown.first_waiter = waiter;
+    } else {
+        waiters_[unknown.last_waiter].next = waiter;
+    }
+    unknown.last_waiter = waiter;
+}
+
+void input::StreamingReader::ResolveWaiters(std::string_view name, StopId stop) {
+    const auto name_id = unknown_names_.Find(name);
+    if (!name_id) {
+        return;
+    }
+
+    auto& unknown = unknown_[*name_id];
+    unknown.stop = stop;
+    uint32_t waiter = std::exchange(unknown.first_waiter, kNone);
+    unknown.last_waiter = kNone;
+
+    while (waiter != kNone) {
+        const auto [next, source, meters] = waiters_[waiter];
+        waiters_[waiter].next = free_waiter_;
+        free_waiter_ = waiter;
+        waiter = next;
+
+        if (meters != 0) {
+            catalogue_.SetDistance(source, stop, meters);
+        } else if (--pending_buses_[source].unresolved_names == 0) {
+            CommitPendingBus(source);
+        }
+    }
+}
+
+void input::StreamingReader::CommitPendingBus(uint32_t index) {
+    auto& bus = pending_buses_[index];
+
+    // Имена подменяются найденными остановками, так и не встреченные
+    // выпадают из маршрута, как при пакетной загрузке
+    route_.clear();
+    for (uint32_t item : bus.route) {
+        if (!(item & kUnresolvedBit)) {
+            route_.push_back(item);
+        } else if (const StopId stop = unknown_[item & ~kUnresolvedBit].stop; stop != kNone) {
+            route_.push_back(stop);
+        }
+    }
+    catalogue_.AddBus(bus.name, route_, bus.is_roundtrip);
+
+    bus.name.clear();
+    bus.route.clear();
+    bus.unresolved_names = 0;
+    free_pending_buses_.push_back(index);
+    --pending_bus_count_;
+}
+
+void input::StreamingReader::Finish(unsigned thread_count) {
+    for (uint32_t index = 0; index < pending_buses_.size(); ++index) {
+        if (pending_buses_[index].unresolved_names > 0) {
+            CommitPendingBus(index);
         }
     }
+
+    pending_buses_.clear();
+    free_pending_buses_.clear();
+    unknown_names_ = transport_catalogue::NameInterner();
+    unknown_.clear();
+    waiters_.clear();
+    free_waiter_ = kNone;
+
+    catalogue_.BuildIndexes(thread_count);
 }
 
 }// input
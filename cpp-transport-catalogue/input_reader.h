@@ -2,11 +2,87 @@
 #include <string>
 #include <string_view>
 #include <vector>
+#include "departure_board.h"
+#include "name_interner.h"
 #include "transport_catalogue.h"
 
 
 namespace input {
 
+/**
+ * Входные данные целиком в памяти: обычный файл отображается через mmap,
+ * канал или терминал вычитываются в буфер одним проходом
+ */
+class InputBuffer {
+public:
+    static InputBuffer FromDescriptor(int fd);
+
+    InputBuffer(InputBuffer&& other) noexcept;
+    InputBuffer& operator=(InputBuffer&& other) = delete;
+    InputBuffer(const InputBuffer&) = delete;
+    InputBuffer& operator=(const InputBuffer&) = delete;
+    ~InputBuffer();
+
+    std::string_view Text() const {
+        return text_;
+    }
+
+    /**
+     * Возвращает очередную строку без символа перевода строки.
+     * Строка указывает в буфер и живёт, пока жив InputBuffer
+     */
+    std::string_view GetLine();
+
+    bool AtEnd() const {
+        return pos_ >= text_.size();
+    }
+
+    // Буфер над уже прочитанным текстом, например остатком потока LineStream
+    static InputBuffer FromString(std::string text);
+
+private:
+    InputBuffer() = default;
+
+    std::string owned_;           // содержимое, если файл не удалось отобразить
+    void* mapped_ = nullptr;      // отображённая область, если файл отображён через mmap
+    size_t mapped_size_ = 0;
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+/**
+ * Построчное чтение блоками: в памяти только непрочитанный хвост последнего блока,
+ * а не весь ввод. Строка живёт до следующего вызова GetLine
+ */
+class LineStream {
+public:
+    explicit LineStream(int fd)
+        : fd_(fd) {
+    }
+
+    std::string_view GetLine();
+
+    bool AtEnd();
+
+    // Весь оставшийся ввод одним буфером, например запросы к базе после загрузки справочника
+    InputBuffer TakeRest();
+
+private:
+    // Дочитывает блок в buffer_, false в конце ввода
+    bool Fill();
+
+    int fd_;
+    std::string buffer_;
+    size_t pos_ = 0;
+    bool eof_ = false;
+};
+
+/**
+ * Читает строку с количеством запросов, пропуская пустые строки
+ */
+int ReadRequestCount(InputBuffer& input);
+int ReadRequestCount(LineStream& input);
+
 struct CommandDescription {
     // Определяет, задана ли команда (поле command непустое)
     explicit operator bool() const {
@@ -17,25 +93,158 @@ struct CommandDescription {
         return !operator bool();
     }
 
-    std::string command;      // Название команды
-    std::string id;           // id маршрута или остановки
-    std::string description;  // Параметры команды
+    std::string_view command;      // Название команды
+    std::string_view id;           // id маршрута или остановки
+    std::string_view description;  // Параметры команды
+};
+
+// Расстояние от остановки до соседней, to указывает во входную строку
+struct StopDistance {
+    int meters;
+    std::string_view to;
 };
 
 class Reader {
 public:
     /**
-     * Парсит строку в структуру CommandDescription и сохраняет результат в commands_
+     * Разбирает строку и сохраняет результат. Строка не копируется:
+     * она должна оставаться в памяти до вызова ApplyCommands
      */
     void ParseLine(std::string_view line);
 
     /**
-     * Наполняет данными транспортный справочник, используя команды из commands_
+     * Разбирает строки параллельно в thread_count потоках.
+     * Результат совпадает с последовательным вызовом ParseLine для каждой строки
+     */
+    void ParseLines(const std::vector<std::string_view>& lines, unsigned thread_count);
+
+    /**
+     * Наполняет данными транспортный справочник, используя разобранные команды.
+     * При thread_count > 1 маршруты и расстояния разрешаются параллельно,
+     * справочник получается тем же, что и при последовательной загрузке
+     */
+    void ApplyCommands(transport_catalogue::TransportCatalogue& catalogue, unsigned thread_count = 1) ;
+
+    // Расписания из команд Timetable в порядке ввода, для DepartureBoard
+    std::vector<transport_catalogue::TripSchedule> TakeSchedules();
+
+private:
+    struct StopCommand {
+        std::string_view name;
+        geo::Coordinates coordinates;
+        size_t distances_begin;       // расстояния остановки занимают
+        size_t distances_end;         // [distances_begin, distances_end) в distances_
+    };
+
+    struct BusCommand {
+        std::string_view name;
+        std::string_view route;
+    };
+
+    // Разобранные команды, у каждого потока разбора свой экземпляр
+    struct Commands {
+        void Parse(std::string_view line);
+        void Append(Commands&& other);
+
+        std::vector<StopCommand> stops;
+        std::vector<BusCommand> buses;
+        std::vector<StopDistance> distances;
+        std::vector<transport_catalogue::TripSchedule> schedules;
+    };
+
+    Commands commands_;
+};
+
+/**
+ * Потоковая загрузка: каждая строка применяется к справочнику сразу и после
+ * вызова может быть освобождена. Остановка добавляется немедленно. Маршрут и
+ * расстояние, которые ссылаются на ещё не встреченные остановки, откладываются
+ * в виде номеров остановок и номеров неизвестных имён и достраиваются, как только
+ * последняя недостающая остановка появится. Так при загрузке в памяти лежит
+ * справочник и отложенные ссылки, а не весь разобранный ввод.
+ *
+ * Справочник получается тем же, что у Reader, с точностью до порядка BusId.
+ * Исключение - повторно заданная остановка: ссылки на неё разрешаются в
+ * определение, известное на момент разрешения, а не в последнее
+ */
+class StreamingReader {
+public:
+    explicit StreamingReader(transport_catalogue::TransportCatalogue& catalogue)
+        : catalogue_(catalogue) {
+    }
+
+    void ApplyLine(std::string_view line);
+
+    /**
+     * Завершает загрузку: отложенные маршруты добавляются без так и не
+     * встреченных остановок, такие расстояния отбрасываются. Затем строятся индексы
      */
-    void ApplyCommands(transport_catalogue::TransportCatalogue& catalogue) ;
+    void Finish(unsigned thread_count = 1);
+
+    // Маршрутов, ожидающих остановки
+    size_t PendingBusCount() const {
+        return pending_bus_count_;
+    }
+
+    // Расписания из команд Timetable в порядке ввода, для DepartureBoard
+    std::vector<transport_catalogue::TripSchedule> TakeSchedules() {
+        return std::move(schedules_);
+    }
 
 private:
-    std::vector<CommandDescription> commands_;
+    using StopId = transport_catalogue::StopId;
+
+    // Элемент отложенного маршрута с этим битом - номер неизвестного имени, а не StopId
+    static constexpr uint32_t kUnresolvedBit = 1u << 31;
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct PendingBus {
+        std::string name;
+        std::vector<uint32_t> route;
+        uint32_t unresolved_names = 0;      // различных ещё не встреченных имён в route
+        bool is_roundtrip = false;
+    };
+
+    // Имя, которое встретилось в ссылке раньше своей остановки
+    struct UnknownName {
+        StopId stop = kNone;                // остановка, когда она появится
+        uint32_t first_waiter = kNone;      // список ожидающих в waiters_, в порядке ввода
+        uint32_t last_waiter = kNone;
+    };
+
+    // Ожидающий остановку: маршрут (meters == 0) или расстояние до неё
+    struct Waiter {
+        uint32_t next;
+        uint32_t source;    // номер в pending_buses_ или StopId, от которой расстояние
+        int meters;
+    };
+
+    void ApplyStop(std::string_view name, std::string_view description);
+    void ApplyBus(std::string_view name, std::string_view route);
+    uint32_t InternUnknown(std::string_view name);
+    void AddWaiter(uint32_t name_id, uint32_t source, int meters);
+    void ResolveWaiters(std::string_view name, StopId stop);
+    void CommitPendingBus(uint32_t index);
+
+    transport_catalogue::TransportCatalogue& catalogue_;
+
+    // Освобождённые места переиспользуются вместе с буферами маршрутов
+    std::vector<PendingBus> pending_buses_;
+    std::vector<uint32_t> free_pending_buses_;
+    size_t pending_bus_count_ = 0;
+
+    transport_catalogue::NameInterner unknown_names_;   // номер имени - индекс в unknown_
+    std::vector<UnknownName> unknown_;
+    // Списки ожидающих всех имён в одном массиве, освобождённые звенья идут в free_waiter_
+    std::vector<Waiter> waiters_;
+    uint32_t free_waiter_ = kNone;
+
+    std::vector<transport_catalogue::TripSchedule> schedules_;
+
+    // Буферы разбора, переиспользуются между строками
+    std::vector<StopDistance> distances_;
+    std::vector<std::string_view> stop_names_;
+    std::vector<StopId> route_;
 };
 
 
@@ -1,37 +1,355 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
 
+#include "catalogue_snapshot.h"
+#include "compact_catalogue.h"
+#include "departure_board.h"
 #include "input_reader.h"
+#include "metrics.h"
+#include "output_writer.h"
+#include "parallel.h"
+#include "server.h"
+#include "spatial_index.h"
 #include "stat_reader.h"
+#include "transport_router.h"
+#include "versioned.h"
 
 
 using namespace std;
 using namespace stat_p;
 
-int main() {
-    transport_catalogue::TransportCatalogue catalogue;
+namespace {
 
-    int base_request_count;
-    cin >> base_request_count >> ws;
+// Всё, что читают запросы к базе: справочник и построенные по нему граф маршрутов,
+// сетка и табло. Индексы ссылаются на справочник того же состояния, поэтому
+// состояние заменяется только целиком
+struct CatalogueState {
+    unique_ptr<transport_catalogue::CatalogueView> catalogue;
+    unique_ptr<router::TransportRouter> router;
+    unique_ptr<transport_catalogue::SpatialIndex> spatial_index;
+    unique_ptr<transport_catalogue::DepartureBoard> departure_board;
+};
 
-    {
-        input::Reader reader;
-        for (int i = 0; i < base_request_count; ++i) {
-            string line;
-            getline(cin, line);
-            reader.ParseLine(line);
+/**
+ * Перезагрузка в отдельном потоке: Request только будит поток, поэтому сервер
+ * отвечает по прежней версии, пока собирается новая. Запросы, пришедшие во время
+ * сборки, сливаются в одну следующую перезагрузку. Поток создаётся при первом
+ * Request и наследует маску сигналов вызвавшего потока
+ */
+class BackgroundReloader {
+public:
+    explicit BackgroundReloader(function<void()> reload)
+        : reload_(std::move(reload)) {
+    }
+
+    BackgroundReloader(const BackgroundReloader&) = delete;
+    BackgroundReloader& operator=(const BackgroundReloader&) = delete;
+
+    // Дожидается начатой перезагрузки
+    ~BackgroundReloader() {
+        {
+            lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        changed_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void Request() {
+        {
+            lock_guard lock(mutex_);
+            pending_ = true;
+            if (!thread_.joinable()) {
+                thread_ = thread([this] {
+                    Run();
+                });
+            }
+        }
+        changed_.notify_one();
+    }
+
+private:
+    void Run() {
+        unique_lock lock(mutex_);
+        while (true) {
+            changed_.wait(lock, [this] {
+                return pending_ || stopping_;
+            });
+            if (stopping_) {
+                return;
+            }
+            pending_ = false;
+            lock.unlock();
+            reload_();
+            lock.lock();
         }
-        reader.ApplyCommands(catalogue);
     }
 
-    int stat_request_count;
-    cin >> stat_request_count >> ws;
-    for (int i = 0; i < stat_request_count; ++i) {
-        string line;
-        getline(cin, line);
-        stat_p::ParseAndPrintStat(catalogue, line, cout);
+    function<void()> reload_;
+    mutex mutex_;
+    condition_variable changed_;
+    bool pending_ = false;
+    bool stopping_ = false;
+    thread thread_;
+};
+
+} // namespace
+
+/**
+ * Параметры командной строки:
+ *   --snapshot FILE       справочник берётся из снимка, на входе только запросы к базе.
+ *                         В режиме сервера SIGHUP перечитывает FILE в фоне, запросы до публикации
+ *                         новой версии отвечаются по прежней
+ *   --save-snapshot FILE  после загрузки базовых запросов справочник сохраняется в снимок
+ *   --streaming 1         базовые запросы применяются по мере чтения, без буфера на весь ввод:
+ *                         память при загрузке определяется справочником, а не размером ввода.
+ *                         Разбор при этом идёт в одном потоке
+ *   --compact 1           загруженный справочник переводится в компактный (CompactCatalogue):
+ *                         меньше памяти, координаты с точностью до 1e-7 градуса. Со --snapshot
+ *                         не действует
+ *   --bus-wait-time MIN   ожидание автобуса для запросов Route, минуты (по умолчанию 6)
+ *   --bus-velocity KMH    скорость автобуса для запросов Route и Departures, км/ч (по умолчанию 40)
+ *   --route-precompute M  предварительный расчёт для запросов Route: none (по умолчанию),
+ *                         auto, table или ch; время построения и память пишутся в stderr
+ *   --cache N             кэш готовых ответов на N запросов: повторы не выполняются заново,
+ *                         ответы прежней версии справочника после SIGHUP не используются.
+ *                         Доля попаданий пишется в stderr
+ *   --listen ADDRESS      режим сервера: после загрузки базы запросы к ней принимаются по одному
+ *                         в строке через unix:<путь> или [<IPv4>:]<порт> до SIGINT или SIGTERM
+ *   --metrics FILE        выгрузка метрик при выходе и по SIGUSR1: FILE.prom - в формате Prometheus,
+ *                         иначе JSON. Замеры есть только в сборке с DEFINES += TRANSPORT_METRICS
+ */
+int main(int argc, char* argv[]) {
+    string snapshot_path;
+    string save_snapshot_path;
+    string listen_address;
+    bool streaming = false;
+    bool compact = false;
+    size_t cache_capacity = 0;
+    router::RoutingSettings routing_settings;
+    router::PrecomputeMode precompute_mode = router::PrecomputeMode::kNone;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const string_view option = argv[i];
+        if (option == "--snapshot") {
+            snapshot_path = argv[i + 1];
+        } else if (option == "--save-snapshot") {
+            save_snapshot_path = argv[i + 1];
+        } else if (option == "--streaming") {
+            streaming = string_view(argv[i + 1]) != "0";
+        } else if (option == "--compact") {
+            compact = string_view(argv[i + 1]) != "0";
+        } else if (option == "--cache") {
+            cache_capacity = stoul(argv[i + 1]);
+        } else if (option == "--metrics") {
+            metrics::ExportOnExit(argv[i + 1]);
+        } else if (option == "--listen") {
+            listen_address = argv[i + 1];
+        } else if (option == "--bus-wait-time") {
+            routing_settings.bus_wait_time = stod(argv[i + 1]);
+        } else if (option == "--bus-velocity") {
+            routing_settings.bus_velocity = stod(argv[i + 1]);
+        } else if (option == "--route-precompute") {
+            const string_view mode = argv[i + 1];
+            if (mode == "none") {
+                precompute_mode = router::PrecomputeMode::kNone;
+            } else if (mode == "auto") {
+                precompute_mode = router::PrecomputeMode::kAuto;
+            } else if (mode == "table") {
+                precompute_mode = router::PrecomputeMode::kAllPairs;
+            } else if (mode == "ch") {
+                precompute_mode = router::PrecomputeMode::kContraction;
+            } else {
+                cerr << "Unknown route precompute mode: " << mode << "\n";
+                return 1;
+            }
+        } else {
+            cerr << "Unknown option: " << option << "\n";
+            return 1;
+        }
     }
 
+    const unsigned thread_count = parallel::DefaultThreadCount();
+
+    // Ввод читается один раз, строки запросов ссылаются прямо в буфер.
+    // При потоковой загрузке в буфер попадает только остаток после базовых запросов
+    optional<input::InputBuffer> input;
+
+    unique_ptr<transport_catalogue::CatalogueView> catalogue;
+    // Расписания маршрутов из команд Timetable; в снимок они не попадают
+    vector<transport_catalogue::TripSchedule> schedules;
+    if (!snapshot_path.empty()) {
+        input.emplace(input::InputBuffer::FromDescriptor(STDIN_FILENO));
+        catalogue = make_unique<transport_catalogue::MappedCatalogue>(snapshot_path);
+    } else {
+        auto built = make_unique<transport_catalogue::TransportCatalogue>();
+
+        if (streaming) {
+            input::LineStream stream(STDIN_FILENO);
+            const int base_request_count = input::ReadRequestCount(stream);
+            input::StreamingReader reader(*built);
+            for (int i = 0; i < base_request_count; ++i) {
+                reader.ApplyLine(stream.GetLine());
+            }
+            reader.Finish(thread_count);
+            schedules = reader.TakeSchedules();
+            input.emplace(stream.TakeRest());
+        } else {
+            input.emplace(input::InputBuffer::FromDescriptor(STDIN_FILENO));
+
+            int base_request_count = input::ReadRequestCount(*input);
+            std::vector<std::string_view> lines;
+            lines.reserve(base_request_count);
+            for (int i = 0; i < base_request_count; ++i) {
+                lines.push_back(input->GetLine());
+            }
+
+            input::Reader reader;
+            reader.ParseLines(lines, thread_count);
+            reader.ApplyCommands(*built, thread_count);
+            schedules = reader.TakeSchedules();
+        }
+
+        if (!save_snapshot_path.empty()) {
+            transport_catalogue::SaveSnapshot(*built, save_snapshot_path);
+        }
+        if (compact) {
+            catalogue = make_unique<transport_catalogue::CompactCatalogue>(*built);
+        } else {
+            catalogue = std::move(built);
+        }
+    }
+
+    // После загрузки справочник только читается, запросы выполняются параллельно.
+    // Сервер заранее не знает запросов, поэтому граф маршрутов и сетка строятся всегда
+    const bool serving = !listen_address.empty();
+    std::vector<std::string_view> requests;
+    if (!serving) {
+        int stat_request_count = input::ReadRequestCount(*input);
+        requests.reserve(stat_request_count);
+        for (int i = 0; i < stat_request_count; ++i) {
+            requests.push_back(input->GetLine());
+        }
+    }
+    auto requested = [&](std::initializer_list<string_view> prefixes) {
+        return serving || any_of(requests.begin(), requests.end(), [prefixes](string_view request) {
+                   return any_of(prefixes.begin(), prefixes.end(), [request](string_view prefix) {
+                       return request.starts_with(prefix);
+                   });
+               });
+    };
+    // Граф маршрутов строится, только если среди запросов есть Route,
+    // сетка - для Nearby и Nearest, табло - для Departures
+    const bool need_router = requested({"Route "});
+    const bool need_spatial_index = requested({"Nearby ", "Nearest "});
+    const bool need_departure_board = requested({"Departures "});
+
+    auto build_state = [&](unique_ptr<transport_catalogue::CatalogueView> catalogue,
+                           const vector<transport_catalogue::TripSchedule>& schedules) {
+        auto state = make_unique<CatalogueState>();
+        state->catalogue = std::move(catalogue);
+        if (need_router) {
+            state->router = make_unique<router::TransportRouter>(*state->catalogue, routing_settings);
+            if (precompute_mode != router::PrecomputeMode::kNone) {
+                state->router->Precompute(precompute_mode, thread_count);
+                const auto& stats = state->router->GetPrecomputeStats();
+                const char* mode_name = stats.mode == router::PrecomputeMode::kAllPairs      ? "all-pairs table"
+                                        : stats.mode == router::PrecomputeMode::kContraction ? "contraction hierarchy"
+                                                                                             : "none, no hierarchy found";
+                cerr << "Route precompute: " << mode_name << ", " << stats.build_seconds << " s, "
+                     << stats.memory_bytes << " bytes\n";
+            }
+        }
+        if (need_spatial_index) {
+            state->spatial_index = make_unique<transport_catalogue::SpatialIndex>(*state->catalogue);
+        }
+        if (need_departure_board) {
+            state->departure_board = make_unique<transport_catalogue::DepartureBoard>(
+                *state->catalogue, schedules, routing_settings.bus_velocity);
+        }
+        return unique_ptr<const CatalogueState>(std::move(state));
+    };
+    parallel::Versioned<CatalogueState> state(build_state(std::move(catalogue), schedules));
+
+    // Ответы в кэше помечены версией состояния, на которой посчитаны: после
+    // перезагрузки прежние ответы не выдаются и вытесняются первыми
+    unique_ptr<ResponseCache> cache;
+    if (cache_capacity > 0) {
+        cache = make_unique<ResponseCache>(cache_capacity);
+    }
+    auto report_cache = [&cache] {
+        if (cache) {
+            const auto stats = cache->GetStats();
+            cerr << "Response cache: " << stats.hits << " hits, " << stats.misses << " misses ("
+                 << stats.HitRate() * 100 << "% hit rate), " << stats.stale << " stale, " << stats.evictions
+                 << " evictions, " << stats.size << " of " << stats.capacity << " entries\n";
+        }
+    };
+
+    if (serving) {
+        // Снимок перечитывается по SIGHUP в фоне; запросы тем временем читают прежнюю версию
+        optional<BackgroundReloader> reloader;
+        server::Server::ReloadHandler on_reload;
+        if (!snapshot_path.empty()) {
+            reloader.emplace([&] {
+                try {
+                    const uint64_t version = state.Publish(
+                        build_state(make_unique<transport_catalogue::MappedCatalogue>(snapshot_path), {}));
+                    cerr << "Reloaded " << snapshot_path << ", version " << version << "\n";
+                } catch (const exception& error) {
+                    cerr << "Reload of " << snapshot_path << " failed: " << error.what() << "\n";
+                    return;
+                }
+                // Прежняя версия удаляется, когда её дочитают начатые запросы
+                while (state.Reclaim() != 0) {
+                    this_thread::sleep_for(chrono::milliseconds(1));
+                }
+            });
+            on_reload = [&reloader] {
+                reloader->Request();
+            };
+        }
+
+        server::Server server(
+            listen_address,
+            [&](string_view request, output::Writer& output) {
+                const auto current = state.Read();
+                if (cache) {
+                    stat_p::ParseAndPrintStat(*current->catalogue, request, output, *cache, current.Version(),
+                                              current->router.get(), current->spatial_index.get(),
+                                              current->departure_board.get());
+                } else {
+                    stat_p::ParseAndPrintStat(*current->catalogue, request, output, current->router.get(),
+                                              current->spatial_index.get(), current->departure_board.get());
+                }
+            },
+            on_reload);
+        cerr << "Listening on " << server.Address() << "\n";
+        server.Run();
+        report_cache();
+        return 0;
+    }
+
+    const auto current = state.Read();
+    output::Writer output(STDOUT_FILENO);
+    stat_p::ParseAndPrintStats(*current->catalogue, requests, output, thread_count, current->router.get(),
+                               current->spatial_index.get(), current->departure_board.get(), cache.get(),
+                               current.Version());
+    output.Flush();
+    report_cache();
+
     return 0;
 }
 
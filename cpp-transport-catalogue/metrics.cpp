@@ -0,0 +1,222 @@
+#include "metrics.h"
+#include <bit>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+
+namespace metrics {
+
+namespace {
+
+// Состояние выгрузки создаётся раньше регистрации atexit и поэтому разрушается
+// после выгрузки при выходе, когда поток сигналов уже остановлен
+struct ExportState {
+    std::mutex mutex;           // выгрузки по сигналу и при выходе не пишут файл одновременно
+    std::string path;
+    std::thread signal_thread;
+    std::atomic<bool> stopping = false;
+};
+
+ExportState& GetExportState() {
+    static ExportState state;
+    return state;
+}
+
+void Export() {
+    ExportState& state = GetExportState();
+    std::lock_guard lock(state.mutex);
+    std::ofstream output(state.path);
+    if (state.path.ends_with(".prom")) {
+        Registry::Instance().WritePrometheus(output);
+    } else {
+        Registry::Instance().WriteJson(output);
+    }
+}
+
+// Останавливает поток сигналов и выгружает метрики в последний раз
+void ExportAtExit() {
+    ExportState& state = GetExportState();
+    if (state.signal_thread.joinable()) {
+        state.stopping = true;
+        pthread_kill(state.signal_thread.native_handle(), SIGUSR1);
+        state.signal_thread.join();
+    }
+    Export();
+}
+
+void WriteSeconds(std::ostream& output, uint64_t nanoseconds) {
+    output << static_cast<double>(nanoseconds) / 1e9;
+}
+
+} // namespace
+
+
+size_t CurrentShard() {
+    static std::atomic<size_t> next_shard = 0;
+    thread_local const size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % kShardCount;
+    return shard;
+}
+
+uint64_t Counter::Value() const {
+    uint64_t value = 0;
+    for (const Shard& shard : shards_) {
+        value += shard.value.load(std::memory_order_relaxed);
+    }
+    return value;
+}
+
+void Histogram::Record(uint64_t nanoseconds) {
+    Shard& shard = shards_[CurrentShard()];
+    const size_t bucket = nanoseconds == 0 ? 0 : std::min<size_t>(std::bit_width(nanoseconds) - 1, kBucketCount - 1);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::Read() const {
+    Snapshot snapshot;
+    for (const Shard& shard : shards_) {
+        snapshot.count += shard.count.load(std::memory_order_relaxed);
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+uint64_t Histogram::Snapshot::Quantile(double quantile) const {
+    uint64_t total = 0;
+    for (const uint64_t bucket : buckets) {
+        total += bucket;
+    }
+    const double target = quantile * static_cast<double>(total);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets[i];
+        if (seen > 0 && static_cast<double>(seen) >= target) {
+            return uint64_t{2} << i;
+        }
+    }
+    return 0;
+}
+
+Registry& Registry::Instance() {
+    static Registry registry;
+    return registry;
+}
+
+Counter& Registry::GetCounter(std::string_view name) {
+    std::lock_guard lock(mutex_);
+    auto it = counters_.find(name);
+    if (it == counters_.end()) {
+        it = counters_.emplace(std::string(name), std::make_unique<Counter>()).first;
+    }
+    return *it->second;
+}
+
+Histogram& Registry::GetHistogram(std::string_view name) {
+    std::lock_guard lock(mutex_);
+    auto it = histograms_.find(name);
+    if (it == histograms_.end()) {
+        it = histograms_.emplace(std::string(name), std::make_unique<Histogram>()).first;
+    }
+    return *it->second;
+}
+
+void Registry::WriteJson(std::ostream& output) const {
+    std::lock_guard lock(mutex_);
+#ifdef TRANSPORT_METRICS
+    output << "{\"enabled\": true,\n \"counters\": {";
+#else
+    output << "{\"enabled\": false,\n \"counters\": {";
+#endif
+    bool first = true;
+    for (const auto& [name, counter] : counters_) {
+        output << (first ? "\n  " : ",\n  ") << '"' << name << "\": " << counter->Value();
+        first = false;
+    }
+    output << "},\n \"timers\": {";
+    first = true;
+    for (const auto& [name, histogram] : histograms_) {
+        const Histogram::Snapshot snapshot = histogram->Read();
+        output << (first ? "\n  " : ",\n  ") << '"' << name << "\": {\"count\": " << snapshot.count
+               << ", \"total_seconds\": ";
+        WriteSeconds(output, snapshot.sum);
+        for (const auto& [label, quantile] : {std::pair{"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"p999", 0.999}}) {
+            output << ", \"" << label << "_seconds\": ";
+            WriteSeconds(output, snapshot.Quantile(quantile));
+        }
+        output << "}";
+        first = false;
+    }
+    output << "}}\n";
+}
+
+void Registry::WritePrometheus(std::ostream& output) const {
+    std::lock_guard lock(mutex_);
+    for (const auto& [name, counter] : counters_) {
+        output << "# TYPE transport_catalogue_" << name << "_total counter\n"
+               << "transport_catalogue_" << name << "_total " << counter->Value() << "\n";
+    }
+    for (const auto& [name, histogram] : histograms_) {
+        const Histogram::Snapshot snapshot = histogram->Read();
+        const std::string metric = "transport_catalogue_" + name + "_seconds";
+        output << "# TYPE " << metric << " histogram\n";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < Histogram::kBucketCount; ++i) {
+            cumulative += snapshot.buckets[i];
+            output << metric << "_bucket{le=\"";
+            WriteSeconds(output, uint64_t{2} << i);
+            output << "\"} " << cumulative << "\n";
+        }
+        output << metric << "_bucket{le=\"+Inf\"} " << snapshot.count << "\n" << metric << "_sum ";
+        WriteSeconds(output, snapshot.sum);
+        output << "\n" << metric << "_count " << snapshot.count << "\n";
+    }
+}
+
+void ExportOnExit(const std::string& path) {
+    // Реестр создаётся раньше регистрации atexit и поэтому разрушается позже выгрузки
+    Registry::Instance();
+    ExportState& state = GetExportState();
+    {
+        std::lock_guard lock(state.mutex);
+        state.path = path;
+    }
+    if (state.signal_thread.joinable()) {
+        return;
+    }
+    std::atexit(ExportAtExit);
+
+    // Поток выгрузки принимает SIGUSR1 через sigwait. Он запускается со всеми
+    // заблокированными сигналами, чтобы не перехватить чужие (например, SIGTERM,
+    // который сервер ждёт через signalfd); остальные потоки наследуют блокировку SIGUSR1.
+    // При выходе ExportAtExit будит его тем же сигналом с флагом stopping
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    sigset_t all_signals;
+    sigfillset(&all_signals);
+    sigset_t previous_mask;
+    pthread_sigmask(SIG_BLOCK, &all_signals, &previous_mask);
+    state.signal_thread = std::thread([signals, &state] {
+        while (true) {
+            int signal = 0;
+            if (sigwait(&signals, &signal) != 0) {
+                continue;
+            }
+            if (state.stopping) {
+                return;
+            }
+            Export();
+        }
+    });
+    sigaddset(&previous_mask, SIGUSR1);
+    pthread_sigmask(SIG_SETMASK, &previous_mask, nullptr);
+}
+
+} // namespace metrics
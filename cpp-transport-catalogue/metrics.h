@@ -0,0 +1,155 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+
+/**
+ * Встроенные метрики: счётчики и таймеры с гистограммой длительностей.
+ *
+ * Точки замера ставятся макросами METRICS_COUNT и METRICS_TIMER. Они
+ * компилируются, только если определён TRANSPORT_METRICS (DEFINES в .pro);
+ * без него макросы пусты и ничего не стоят. Классы ниже доступны всегда,
+ * так что выгрузка работает в любой сборке - без TRANSPORT_METRICS она пуста
+ */
+namespace metrics {
+
+// Потоки пишут в разные доли, чтобы параллельная обработка не упиралась в одну кэш-линию
+inline constexpr size_t kShardCount = 16;
+
+size_t CurrentShard();
+
+class Counter {
+public:
+    void Add(uint64_t delta) {
+        shards_[CurrentShard()].value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    uint64_t Value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, kShardCount> shards_;
+};
+
+/**
+ * Длительности в наносекундах: корзина i считает значения из [2^i, 2^(i+1)),
+ * нулевая - ещё и значения меньше 1 нс
+ */
+class Histogram {
+public:
+    static constexpr size_t kBucketCount = 40;
+
+    void Record(uint64_t nanoseconds);
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;          // наносекунды
+        std::array<uint64_t, kBucketCount> buckets{};
+
+        // Верхняя граница корзины, в которую попадает доля quantile значений
+        uint64_t Quantile(double quantile) const;
+    };
+    Snapshot Read() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::array<std::atomic<uint64_t>, kBucketCount> buckets{};
+    };
+    std::array<Shard, kShardCount> shards_;
+};
+
+// Записывает длительность своей области видимости в гистограмму
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram)
+        , start_(std::chrono::steady_clock::now()) {
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        histogram_.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * Все метрики процесса по именам. Метрики создаются при первом обращении
+ * и живут до конца программы, ссылки на них можно хранить
+ */
+class Registry {
+public:
+    static Registry& Instance();
+
+    Counter& GetCounter(std::string_view name);
+    Histogram& GetHistogram(std::string_view name);
+
+    // {"enabled": ..., "counters": {...}, "timers": {"имя": {"count", "total_seconds", "p50_seconds", ...}}}
+    void WriteJson(std::ostream& output) const;
+
+    // Текстовый формат Prometheus: счётчики с суффиксом _total, таймеры - гистограммы в секундах
+    void WritePrometheus(std::ostream& output) const;
+
+private:
+    Registry() = default;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<Counter>, std::less<>> counters_;
+    std::map<std::string, std::unique_ptr<Histogram>, std::less<>> histograms_;
+};
+
+/**
+ * Выгружает метрики в path при выходе из программы и по сигналу SIGUSR1.
+ * Файл с расширением .prom пишется в формате Prometheus, остальные - в JSON.
+ * Вызывается до запуска других потоков: SIGUSR1 блокируется во всех потоках
+ * программы и принимается отдельным потоком, который при выходе останавливается
+ * до последней выгрузки. Выгрузки не пересекаются, файл пишется целиком.
+ * Повторный вызов только меняет path
+ */
+void ExportOnExit(const std::string& path);
+
+} // namespace metrics
+
+
+#ifdef TRANSPORT_METRICS
+
+#define METRICS_CONCAT_IMPL(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_IMPL(a, b)
+
+// Прибавляет delta к счётчику name; name - строковый литерал
+#define METRICS_COUNT(name, delta)                                                                       \
+    do {                                                                                                 \
+        static ::metrics::Counter& metrics_counter = ::metrics::Registry::Instance().GetCounter(name); \
+        metrics_counter.Add(delta);                                                                      \
+    } while (false)
+
+// Замеряет время до конца области видимости в гистограмму name
+#define METRICS_TIMER(name)                                                                               \
+    static ::metrics::Histogram& METRICS_CONCAT(metrics_histogram_, __LINE__) =                           \
+        ::metrics::Registry::Instance().GetHistogram(name);                                               \
+    ::metrics::ScopedTimer METRICS_CONCAT(metrics_timer_, __LINE__)(METRICS_CONCAT(metrics_histogram_, __LINE__))
+
+#else
+
+#define METRICS_COUNT(name, delta) ((void)0)
+#define METRICS_TIMER(name) ((void)0)
+
+#endif
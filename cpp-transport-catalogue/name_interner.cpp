@@ -0,0 +1,90 @@
+#include "name_interner.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace transport_catalogue {
+
+NameInterner::NameId NameInterner::Intern(std::string_view name) {
+
+    if (slots_.size() < (names_.size() + 1) * 2) {
+        Grow();
+    }
+
+    const size_t hash = std::hash<std::string_view>{}(name);
+    const size_t slot = FindSlot(name, hash);
+    if (slots_[slot] != kEmptySlot) {
+        return slots_[slot];
+    }
+
+    const NameId id = static_cast<NameId>(names_.size());
+    names_.push_back(Store(name));
+    hashes_.push_back(hash);
+    slots_[slot] = id;
+    return id;
+}
+
+std::optional<NameInterner::NameId> NameInterner::Find(std::string_view name) const {
+
+    if (slots_.empty()) {
+        return std::nullopt;
+    }
+
+    const size_t slot = FindSlot(name, std::hash<std::string_view>{}(name));
+    if (slots_[slot] == kEmptySlot) {
+        return std::nullopt;
+    }
+    return slots_[slot];
+}
+
+// Ячейка с этим именем или пустая ячейка, куда его следует положить
+size_t NameInterner::FindSlot(std::string_view name, size_t hash) const {
+
+    const size_t mask = slots_.size() - 1;
+    size_t slot = hash & mask;
+    while (slots_[slot] != kEmptySlot) {
+        const NameId id = slots_[slot];
+        if (hashes_[id] == hash && names_[id] == name) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void NameInterner::Grow() {
+
+    const size_t capacity = std::max<size_t>(16, slots_.size() * 2);
+    slots_.assign(capacity, kEmptySlot);
+
+    // Перекладываем по сохранённым хешам, строки не хешируются повторно
+    const size_t mask = capacity - 1;
+    for (NameId id = 0; id < names_.size(); ++id) {
+        size_t slot = hashes_[id] & mask;
+        while (slots_[slot] != kEmptySlot) {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = id;
+    }
+}
+
+std::string_view NameInterner::Store(std::string_view name) {
+
+    if (name.size() > block_left_) {
+        const size_t size = std::max(kBlockSize, name.size());
+        blocks_.emplace_back(new char[size]); // без обнуления, в отличие от make_unique
+        block_pos_ = blocks_.back().get();
+        block_left_ = size;
+        arena_bytes_ += size;
+    }
+
+    if (!name.empty()) {
+        std::memcpy(block_pos_, name.data(), name.size());
+    }
+    const std::string_view stored(block_pos_, name.size());
+    block_pos_ += name.size();
+    block_left_ -= name.size();
+    return stored;
+}
+
+} // namespace transport_catalogue
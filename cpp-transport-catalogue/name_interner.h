@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+
+namespace transport_catalogue {
+
+/**
+ * Хранит каждое различное имя один раз в арене из крупных блоков и выдаёт
+ * для него номер. Строки в арене не перемещаются, поэтому string_view,
+ * полученные через Get, действительны всё время жизни интернатора.
+ * Хеши имён считаются один раз при добавлении и используются при поиске и росте таблицы
+ */
+class NameInterner {
+public:
+    using NameId = uint32_t;
+
+    NameInterner() = default;
+    NameInterner(const NameInterner&) = delete;
+    NameInterner& operator=(const NameInterner&) = delete;
+    NameInterner(NameInterner&&) = default;
+    NameInterner& operator=(NameInterner&&) = default;
+
+    // Возвращает номер имени, добавляя его при первом появлении
+    NameId Intern(std::string_view name);
+
+    std::optional<NameId> Find(std::string_view name) const;
+
+    std::string_view Get(NameId id) const {
+        return names_[id];
+    }
+
+    size_t Size() const {
+        return names_.size();
+    }
+
+    // Байт, занятых блоками арены
+    size_t ArenaBytes() const {
+        return arena_bytes_;
+    }
+
+private:
+    static constexpr uint32_t kEmptySlot = UINT32_MAX;
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    std::string_view Store(std::string_view name);
+    size_t FindSlot(std::string_view name, size_t hash) const;
+    void Grow();
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* block_pos_ = nullptr;
+    size_t block_left_ = 0;
+    size_t arena_bytes_ = 0;
+
+    std::vector<std::string_view> names_;
+    std::vector<size_t> hashes_;
+    std::vector<uint32_t> slots_; // открытая адресация, в ячейках - номера имён
+};
+
+} // namespace transport_catalogue
@@ -0,0 +1,48 @@
+#include "output_writer.h"
+#include <cerrno>
+#include <unistd.h>
+
+namespace output {
+
+Writer::Writer(int fd, size_t flush_threshold)
+    : fd_(fd)
+    , flush_threshold_(flush_threshold) {
+
+    if (fd_ >= 0) {
+        buffer_.reserve(flush_threshold_ + 4096);
+    }
+}
+
+Writer::~Writer() {
+    Flush();
+}
+
+Writer& Writer::operator<<(double value) {
+    // Формат совпадает с std::ostream << setprecision(6) << value, то есть с printf("%.6g")
+    char chars[32];
+    auto [end, ec] = std::to_chars(chars, chars + sizeof(chars), value, std::chars_format::general, 6);
+    return *this << std::string_view(chars, end - chars);
+}
+
+void Writer::Flush() {
+    if (fd_ < 0) {
+        return;
+    }
+
+    const char* data = buffer_.data();
+    size_t left = buffer_.size();
+    while (left > 0) {
+        const ssize_t written = write(fd_, data, left);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break; // Ошибка записи: вывод дальше невозможен
+        }
+        data += written;
+        left -= written;
+    }
+    buffer_.clear();
+}
+
+} // namespace output
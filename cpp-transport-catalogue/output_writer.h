@@ -0,0 +1,72 @@
+#pragma once
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+namespace output {
+
+/**
+ * Буферизованный вывод без iostream. Числа форматируются через std::to_chars,
+ * вещественные - как поток с настройками по умолчанию (6 значащих цифр).
+ * С файловым дескриптором буфер сбрасывается крупными блоками по заполнении,
+ * без дескриптора (fd < 0) данные копятся в памяти и доступны через View()
+ */
+class Writer {
+public:
+    explicit Writer(int fd = -1, size_t flush_threshold = 1 << 20);
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    Writer(Writer&&) = default;
+    Writer& operator=(Writer&&) = default;
+
+    ~Writer();
+
+    Writer& operator<<(std::string_view text) {
+        buffer_.append(text);
+        MaybeFlush();
+        return *this;
+    }
+
+    Writer& operator<<(char c) {
+        buffer_.push_back(c);
+        MaybeFlush();
+        return *this;
+    }
+
+    template <typename Integer, std::enable_if_t<std::is_integral_v<Integer>, int> = 0>
+    Writer& operator<<(Integer value) {
+        char chars[24];
+        auto [end, ec] = std::to_chars(chars, chars + sizeof(chars), value);
+        return *this << std::string_view(chars, end - chars);
+    }
+
+    Writer& operator<<(double value);
+
+    // Содержимое, ещё не отправленное в дескриптор
+    std::string_view View() const {
+        return buffer_;
+    }
+
+    void Clear() {
+        buffer_.clear();
+    }
+
+    // Отправляет накопленное в дескриптор; без дескриптора ничего не делает
+    void Flush();
+
+private:
+    void MaybeFlush() {
+        if (fd_ >= 0 && buffer_.size() >= flush_threshold_) {
+            Flush();
+        }
+    }
+
+    int fd_;
+    size_t flush_threshold_;
+    std::string buffer_;
+};
+
+} // namespace output
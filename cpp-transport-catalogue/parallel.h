@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace parallel {
+
+// Число потоков по умолчанию - по числу ядер
+inline unsigned DefaultThreadCount() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * Делит диапазон [0, size) на thread_count непрерывных кусков по возрастанию
+ * и вызывает func(begin, end, chunk) для каждого куска в отдельном потоке.
+ * Первое исключение из потоков пробрасывается после их завершения
+ */
+template <typename Func>
+void ForEachChunk(size_t size, unsigned thread_count, Func func) {
+    thread_count = static_cast<unsigned>(std::clamp<size_t>(thread_count, 1, std::max<size_t>(size, 1)));
+
+    if (thread_count == 1) {
+        func(size_t{0}, size, 0u);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(thread_count);
+    auto run = [&](unsigned chunk) {
+        try {
+            func(size * chunk / thread_count, size * (chunk + 1) / thread_count, chunk);
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (unsigned chunk = 1; chunk < thread_count; ++chunk) {
+        threads.emplace_back(run, chunk);
+    }
+    run(0);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/**
+ * Вызывает func(block, worker) для блоков [0, block_count) в thread_count потоках,
+ * созданных один раз на весь вызов. Потоки берут следующий блок из общего счётчика,
+ * поэтому долгие блоки не задерживают остальные потоки. Готовые блоки передаются
+ * в consume(block) в вызывающем потоке строго по возрастанию номеров. Вперёд
+ * последнего переданного блока обрабатывается меньше max_ahead блоков, так что
+ * результаты блока можно хранить в ячейке block % max_ahead.
+ * Первое исключение останавливает раздачу блоков и пробрасывается после завершения потоков
+ */
+template <typename Func, typename Consume>
+void ForEachBlockOrdered(size_t block_count, unsigned thread_count, size_t max_ahead, Func func, Consume consume) {
+    thread_count = static_cast<unsigned>(std::clamp<size_t>(thread_count, 1, std::max<size_t>(block_count, 1)));
+    max_ahead = std::max<size_t>(max_ahead, 1);
+
+    if (thread_count == 1) {
+        for (size_t block = 0; block < block_count; ++block) {
+            func(block, 0u);
+            consume(block);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next_block = 0;
+    std::mutex mutex;
+    std::condition_variable changed;
+    // Под mutex: готовность ячеек, число переданных в consume блоков и первая ошибка
+    std::vector<char> ready(max_ahead, false);
+    size_t consumed = 0;
+    std::exception_ptr error;
+
+    auto fail = [&] {
+        {
+            std::lock_guard lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+        changed.notify_all();
+    };
+
+    auto work = [&](unsigned worker) {
+        try {
+            for (size_t block = next_block++; block < block_count; block = next_block++) {
+                {
+                    // Ячейка блока освобождается, когда consume получил блок block - max_ahead
+                    std::unique_lock lock(mutex);
+                    changed.wait(lock, [&] {
+                        return block < consumed + max_ahead || error;
+                    });
+                    if (error) {
+                        return;
+                    }
+                }
+                func(block, worker);
+                {
+                    std::lock_guard lock(mutex);
+                    ready[block % max_ahead] = true;
+                }
+                changed.notify_all();
+            }
+        } catch (...) {
+            fail();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    for (unsigned worker = 0; worker < thread_count; ++worker) {
+        threads.emplace_back(work, worker);
+    }
+
+    try {
+        for (size_t block = 0; block < block_count; ++block) {
+            {
+                std::unique_lock lock(mutex);
+                changed.wait(lock, [&] {
+                    return ready[block % max_ahead] || error;
+                });
+                if (error) {
+                    break;
+                }
+                ready[block % max_ahead] = false;
+            }
+            consume(block);
+            {
+                std::lock_guard lock(mutex);
+                ++consumed;
+            }
+            changed.notify_all();
+        }
+    } catch (...) {
+        fail();
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace parallel
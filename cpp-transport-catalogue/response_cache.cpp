@@ -0,0 +1,194 @@
+#include "response_cache.h"
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+#include "metrics.h"
+
+namespace stat_p {
+
+namespace {
+
+// Долей не больше, чем нужно, чтобы потоки редко ждали друг друга
+constexpr size_t kMaxShardCount = 16;
+constexpr size_t kMinShardCapacity = 256;
+
+uint32_t TagOf(uint64_t hash) {
+    return static_cast<uint32_t>(hash >> 32);
+}
+
+} // namespace
+
+
+ResponseCache::ResponseCache(size_t capacity, size_t max_response_size)
+    : capacity_(capacity)
+    , max_response_size_(max_response_size)
+    , shard_count_(std::clamp<size_t>(capacity / kMinShardCapacity, 1, kMaxShardCount))
+    , shards_(std::make_unique<Shard[]>(shard_count_)) {
+
+    for (size_t i = 0; i < shard_count_; ++i) {
+        const size_t shard_capacity = capacity / shard_count_ + (i < capacity % shard_count_ ? 1 : 0);
+        shards_[i].entries.resize(shard_capacity);
+        shards_[i].slots.resize(std::bit_ceil(std::max<size_t>(shard_capacity * 2, 2)));
+    }
+}
+
+bool ResponseCache::Lookup(std::string_view request, uint64_t version, output::Writer& output) {
+
+    const uint64_t hash = std::hash<std::string_view>{}(request);
+    Shard& shard = ShardFor(hash);
+    std::lock_guard lock(shard.mutex);
+
+    const uint32_t index = shard.slots[Probe(shard, request, hash)].entry;
+    if (index == kEmptySlot || shard.entries[index].version != version) {
+        METRICS_COUNT("stat_cache_misses", 1);
+        ++shard.stats.misses;
+        if (index != kEmptySlot) {
+            ++shard.stats.stale;
+        }
+        return false;
+    }
+
+    METRICS_COUNT("stat_cache_hits", 1);
+    ++shard.stats.hits;
+    Entry& entry = shard.entries[index];
+    entry.referenced = true;
+    output << std::string_view(entry.text).substr(entry.request_size);
+    return true;
+}
+
+void ResponseCache::Insert(std::string_view request, uint64_t version, std::string_view response) {
+
+    if (capacity_ == 0 || response.size() > max_response_size_) {
+        return;
+    }
+
+    const uint64_t hash = std::hash<std::string_view>{}(request);
+    Shard& shard = ShardFor(hash);
+    std::lock_guard lock(shard.mutex);
+
+    // Ответ, посчитанный на прежней версии, уже никому не нужен
+    if (version < shard.latest_version) {
+        return;
+    }
+    shard.latest_version = version;
+
+    size_t slot = Probe(shard, request, hash);
+    uint32_t index = shard.slots[slot].entry;
+    if (index == kEmptySlot) {
+        index = TakeVictim(shard);
+        Entry& victim = shard.entries[index];
+        if (victim.used) {
+            EraseSlot(shard, Probe(shard, std::string_view(victim.text).substr(0, victim.request_size), victim.hash));
+            --shard.size;
+            // Сдвиг мог занять найденную пустую ячейку
+            slot = Probe(shard, request, hash);
+        }
+        shard.slots[slot] = {TagOf(hash), index};
+        shard.entries[index].referenced = false;
+        ++shard.size;
+        ++shard.stats.insertions;
+    }
+
+    // Строка записи переиспользуется, новая память нужна только под более длинный текст
+    Entry& entry = shard.entries[index];
+    entry.text.assign(request);
+    entry.text.append(response);
+    entry.hash = hash;
+    entry.version = version;
+    entry.request_size = static_cast<uint32_t>(request.size());
+    entry.used = true;
+}
+
+void ResponseCache::Clear() {
+
+    for (size_t i = 0; i < shard_count_; ++i) {
+        Shard& shard = shards_[i];
+        std::lock_guard lock(shard.mutex);
+        std::fill(shard.slots.begin(), shard.slots.end(), Slot{});
+        for (Entry& entry : shard.entries) {
+            entry.used = false;
+            entry.referenced = false;
+        }
+        shard.hand = 0;
+        shard.size = 0;
+    }
+}
+
+ResponseCache::Stats ResponseCache::GetStats() const {
+
+    Stats total;
+    total.capacity = capacity_;
+    for (size_t i = 0; i < shard_count_; ++i) {
+        const Shard& shard = shards_[i];
+        std::lock_guard lock(shard.mutex);
+        total.hits += shard.stats.hits;
+        total.misses += shard.stats.misses;
+        total.stale += shard.stats.stale;
+        total.insertions += shard.stats.insertions;
+        total.evictions += shard.stats.evictions;
+        total.size += shard.size;
+    }
+    return total;
+}
+
+ResponseCache::Shard& ResponseCache::ShardFor(uint64_t hash) const {
+    // Младшие биты выбирают ячейку внутри доли
+    return shards_[TagOf(hash) % shard_count_];
+}
+
+size_t ResponseCache::Probe(const Shard& shard, std::string_view request, uint64_t hash) {
+
+    const size_t mask = shard.slots.size() - 1;
+    const uint32_t tag = TagOf(hash);
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        const Slot& cell = shard.slots[slot];
+        if (cell.entry == kEmptySlot) {
+            return slot;
+        }
+        if (cell.tag == tag) {
+            const Entry& entry = shard.entries[cell.entry];
+            if (entry.hash == hash && std::string_view(entry.text).substr(0, entry.request_size) == request) {
+                return slot;
+            }
+        }
+    }
+}
+
+void ResponseCache::EraseSlot(Shard& shard, size_t slot) {
+
+    // Запись из следующей ячейки переезжает в дыру, если дыра лежит между
+    // её домашней ячейкой и текущим местом - иначе поиск бы её потерял
+    const size_t mask = shard.slots.size() - 1;
+    for (size_t next = (slot + 1) & mask; shard.slots[next].entry != kEmptySlot; next = (next + 1) & mask) {
+        const size_t home = shard.entries[shard.slots[next].entry].hash & mask;
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            shard.slots[slot] = shard.slots[next];
+            slot = next;
+        }
+    }
+    shard.slots[slot] = Slot{};
+}
+
+uint32_t ResponseCache::TakeVictim(Shard& shard) {
+
+    // За два оборота стрелка обязательно найдёт запись: на первом она снимает все биты
+    while (true) {
+        const auto index = static_cast<uint32_t>(shard.hand);
+        Entry& entry = shard.entries[index];
+        shard.hand = (shard.hand + 1) % shard.entries.size();
+
+        if (!entry.used || entry.version < shard.latest_version) {
+            return index;
+        }
+        if (entry.referenced) {
+            entry.referenced = false;
+            continue;
+        }
+        METRICS_COUNT("stat_cache_evictions", 1);
+        ++shard.stats.evictions;
+        return index;
+    }
+}
+
+} // namespace stat_p
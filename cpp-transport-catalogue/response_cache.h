@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "output_writer.h"
+
+
+namespace stat_p {
+
+/**
+ * Кэш готовых ответов на запросы к базе: текст запроса -> отформатированный ответ.
+ *
+ * Ответ помечен версией справочника, на которой он получен (например,
+ * parallel::Versioned::ReadGuard::Version()); ответ другой версии считается
+ * промахом, а после записи ответа более новой версии устаревшие записи
+ * вытесняются первыми. Число записей ограничено, вытеснение - по алгоритму CLOCK:
+ * попадание только ставит бит обращения, стрелка снимает биты и забирает первую
+ * запись без бита. Кэш разбит на доли со своими блокировками, поэтому его
+ * можно разделять между потоками
+ */
+class ResponseCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stale = 0;         // промахи из-за записи прежней версии
+        uint64_t insertions = 0;
+        uint64_t evictions = 0;     // вытеснены действующие записи
+        size_t size = 0;
+        size_t capacity = 0;
+
+        double HitRate() const {
+            return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+        }
+    };
+
+    // Ответы длиннее max_response_size не кэшируются
+    explicit ResponseCache(size_t capacity, size_t max_response_size = 4096);
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    // Дописывает ответ в output и возвращает true, если ответ версии version есть в кэше
+    bool Lookup(std::string_view request, uint64_t version, output::Writer& output);
+
+    void Insert(std::string_view request, uint64_t version, std::string_view response);
+
+    // Удаляет все записи, статистика сохраняется
+    void Clear();
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        std::string text;           // запрос, за ним ответ: одна строка - одно обращение к памяти
+        uint64_t hash = 0;
+        uint64_t version = 0;
+        uint32_t request_size = 0;
+        bool used = false;
+        bool referenced = false;
+    };
+
+    static constexpr uint32_t kEmptySlot = UINT32_MAX;
+
+    // Ячейка таблицы с открытой адресацией: часть хеша позволяет не читать чужие записи
+    struct Slot {
+        uint32_t tag = 0;
+        uint32_t entry = kEmptySlot;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::vector<Entry> entries;
+        std::vector<Slot> slots;    // размер - степень двойки, не меньше удвоенного числа записей
+        size_t hand = 0;
+        size_t size = 0;
+        uint64_t latest_version = 0;
+        Stats stats;
+    };
+
+    Shard& ShardFor(uint64_t hash) const;
+    // Ячейка с записью запроса или пустая ячейка, куда её можно поставить
+    static size_t Probe(const Shard& shard, std::string_view request, uint64_t hash);
+    // Освобождает ячейку, сдвигая назад следующие за ней записи
+    static void EraseSlot(Shard& shard, size_t slot);
+    // Свободная, устаревшая или давно не читанная запись
+    static uint32_t TakeVictim(Shard& shard);
+
+    size_t capacity_;
+    size_t max_response_size_;
+    size_t shard_count_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+} // namespace stat_p
@@ -0,0 +1,315 @@
+#include "server.h"
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace server {
+
+namespace {
+
+// Сколько байт читается из сокета за раз
+constexpr size_t kReadChunk = 64 * 1024;
+
+// Сколько событий epoll забирается за один вызов
+constexpr int kMaxEvents = 256;
+
+[[noreturn]] void ThrowSystemError(const std::string& what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+
+Server::Server(std::string_view address, Handler handler, ReloadHandler on_reload)
+    : handler_(std::move(handler))
+    , on_reload_(std::move(on_reload)) {
+
+    if (address.starts_with("unix:")) {
+        unix_path_ = address.substr(5);
+        sockaddr_un socket_address{};
+        if (unix_path_.empty() || unix_path_.size() >= sizeof(socket_address.sun_path)) {
+            throw std::runtime_error("Invalid socket path: " + unix_path_);
+        }
+        socket_address.sun_family = AF_UNIX;
+        std::memcpy(socket_address.sun_path, unix_path_.data(), unix_path_.size());
+
+        // Сокет, оставшийся от прошлого запуска, мешает bind
+        struct stat status;
+        if (lstat(unix_path_.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+            unlink(unix_path_.c_str());
+        }
+
+        listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) {
+            ThrowSystemError("Cannot create socket");
+        }
+        if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&socket_address), sizeof(socket_address)) < 0) {
+            close(listen_fd_);
+            ThrowSystemError("Cannot bind " + unix_path_);
+        }
+        address_ = "unix:" + unix_path_;
+    } else {
+        std::string host = "127.0.0.1";
+        std::string_view port = address;
+        if (const auto colon = address.rfind(':'); colon != address.npos) {
+            host = address.substr(0, colon);
+            port = address.substr(colon + 1);
+        }
+
+        sockaddr_in socket_address{};
+        socket_address.sin_family = AF_INET;
+        unsigned port_number = 0;
+        const auto [end, ec] = std::from_chars(port.data(), port.data() + port.size(), port_number);
+        if (port.empty() || ec != std::errc() || end != port.data() + port.size() || port_number > 65535
+            || inet_pton(AF_INET, host.c_str(), &socket_address.sin_addr) != 1) {
+            throw std::runtime_error("Invalid address: " + std::string(address));
+        }
+        socket_address.sin_port = htons(static_cast<uint16_t>(port_number));
+
+        listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) {
+            ThrowSystemError("Cannot create socket");
+        }
+        const int enable = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        socklen_t length = sizeof(socket_address);
+        if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&socket_address), sizeof(socket_address)) < 0
+            || getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&socket_address), &length) < 0) {
+            close(listen_fd_);
+            ThrowSystemError("Cannot bind " + std::string(address));
+        }
+        address_ = host + ":" + std::to_string(ntohs(socket_address.sin_port));
+    }
+
+    if (listen(listen_fd_, SOMAXCONN) < 0) {
+        close(listen_fd_);
+        ThrowSystemError("Cannot listen on " + address_);
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || stop_fd_ < 0) {
+        const int error = errno;
+        close(listen_fd_);
+        close(epoll_fd_);
+        close(stop_fd_);
+        errno = error;
+        ThrowSystemError("Cannot create epoll");
+    }
+    for (const int fd : {listen_fd_, stop_fd_}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+Server::~Server() {
+    for (const auto& [fd, connection] : connections_) {
+        close(fd);
+    }
+    close(listen_fd_);
+    close(epoll_fd_);
+    close(stop_fd_);
+    if (!unix_path_.empty()) {
+        unlink(unix_path_.c_str());
+    }
+}
+
+void Server::Run() {
+    // Сигналы завершения приходят через signalfd вместе с остальными событиями
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    if (on_reload_) {
+        sigaddset(&signals, SIGHUP);
+    }
+    sigset_t previous_mask;
+    pthread_sigmask(SIG_BLOCK, &signals, &previous_mask);
+    const int signal_fd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd >= 0) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = signal_fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, signal_fd, &event);
+    }
+
+    epoll_event events[kMaxEvents];
+    bool running = true;
+    while (running) {
+        const int count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == stop_fd_) {
+                uint64_t drained = 0;
+                [[maybe_unused]] const ssize_t received = read(fd, &drained, sizeof(drained));
+                running = false;
+            } else if (fd == signal_fd) {
+                // Сигнал вычитывается, иначе он сработает при восстановлении маски
+                signalfd_siginfo info{};
+                if (read(fd, &info, sizeof(info)) != sizeof(info)) {
+                    continue;
+                }
+                if (info.ssi_signo == SIGHUP) {
+                    on_reload_();
+                } else {
+                    running = false;
+                }
+            } else if (fd == listen_fd_) {
+                Accept();
+            } else if (const auto it = connections_.find(fd); it != connections_.end()) {
+                Connection& connection = it->second;
+                if (events[i].events & EPOLLOUT) {
+                    if (!Send(fd, connection)) {
+                        Close(fd);
+                    }
+                } else if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    Receive(fd, connection);
+                }
+            }
+        }
+    }
+
+    if (signal_fd >= 0) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, signal_fd, nullptr);
+        close(signal_fd);
+    }
+    pthread_sigmask(SIG_SETMASK, &previous_mask, nullptr);
+}
+
+void Server::Stop() {
+    const uint64_t value = 1;
+    [[maybe_unused]] const ssize_t written = write(stop_fd_, &value, sizeof(value));
+}
+
+void Server::Accept() {
+    while (true) {
+        const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return; // EAGAIN - очередь пуста; прочие ошибки касаются одного клиента
+        }
+        if (unix_path_.empty()) {
+            // Ответы и так собираются в одну запись, ждать добора пакета незачем
+            const int enable = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        }
+        connections_.try_emplace(fd);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+void Server::Receive(int fd, Connection& connection) {
+    char chunk[kReadChunk];
+    const ssize_t received = read(fd, chunk, kReadChunk);
+    if (received < 0) {
+        if (errno != EAGAIN && errno != EINTR) {
+            Close(fd);
+        }
+        return;
+    }
+    connection.input.append(chunk, received);
+    if (received == 0) {
+        // Последняя строка может прийти без перевода строки
+        if (!connection.input.empty()) {
+            connection.input.push_back('\n');
+        }
+        connection.closing = true;
+    }
+
+    // Все полученные целиком строки выполняются подряд, ответы копятся в output
+    size_t begin = 0;
+    for (size_t end; (end = connection.input.find('\n', begin)) != std::string::npos; begin = end + 1) {
+        std::string_view request(connection.input.data() + begin, end - begin);
+        if (request.ends_with('\r')) {
+            request.remove_suffix(1);
+        }
+        if (request.empty()) {
+            continue;
+        }
+        const size_t output_size = connection.output.View().size();
+        handler_(request, connection.output);
+        if (connection.output.View().size() == output_size) {
+            // Ответ есть на каждый запрос, иначе клиент не сопоставит ответы с запросами
+            connection.output << "Unknown request: " << request << "\n";
+        }
+    }
+    connection.input.erase(0, begin);
+    if (connection.input.size() > kMaxRequestSize) {
+        Close(fd);
+        return;
+    }
+
+    if (!Send(fd, connection)) {
+        Close(fd);
+    }
+}
+
+bool Server::Send(int fd, Connection& connection) {
+    const std::string_view data = connection.output.View();
+    while (connection.sent < data.size()) {
+        const ssize_t written = send(fd, data.data() + connection.sent, data.size() - connection.sent, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                // Дальше по готовности сокета; чтение запросов приостанавливается
+                if (!connection.waiting_write) {
+                    connection.waiting_write = true;
+                    Watch(fd, true);
+                }
+                return true;
+            }
+            return false;
+        }
+        connection.sent += written;
+    }
+    connection.output.Clear();
+    connection.sent = 0;
+    if (connection.closing) {
+        return false;
+    }
+    if (connection.waiting_write) {
+        connection.waiting_write = false;
+        Watch(fd, false);
+    }
+    return true;
+}
+
+void Server::Watch(int fd, bool for_write) {
+    epoll_event event{};
+    event.events = for_write ? EPOLLOUT : EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+}
+
+void Server::Close(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections_.erase(fd);
+}
+
+} // namespace server
@@ -0,0 +1,77 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "output_writer.h"
+
+
+namespace server {
+
+/**
+ * Однопоточный сервер построчных запросов на epoll с неблокирующими сокетами.
+ *
+ * Адрес - "unix:<путь>" для Unix-сокета или "[<IPv4>:]<порт>" для TCP
+ * (по умолчанию 127.0.0.1, порт 0 - любой свободный). Каждая строка запроса
+ * передаётся обработчику, который пишет ответ в Writer. Клиент может слать
+ * запросы, не дожидаясь ответов: все строки, прочитанные за раз, обрабатываются
+ * подряд, а их ответы уходят одной записью в сокет. Пока ответы соединения
+ * не отправлены целиком, новые запросы с него не читаются.
+ * Если задан обработчик перезагрузки, он вызывается в потоке сервера по SIGHUP
+ */
+class Server {
+public:
+    using Handler = std::function<void(std::string_view request, output::Writer& output)>;
+    // Должен вернуться быстро: долгую перезагрузку он только запускает
+    using ReloadHandler = std::function<void()>;
+
+    // Самая длинная строка запроса; соединение с более длинной строкой закрывается
+    static constexpr size_t kMaxRequestSize = 1 << 20;
+
+    // Бросает std::runtime_error, если адрес некорректен или сокет не открывается
+    Server(std::string_view address, Handler handler, ReloadHandler on_reload = nullptr);
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+    ~Server();
+
+    // Фактический адрес в том же формате, с настоящим номером порта
+    const std::string& Address() const {
+        return address_;
+    }
+
+    // Обслуживает соединения до SIGINT или SIGTERM либо до вызова Stop.
+    // Созданные из обработчиков потоки наследуют блокировку этих сигналов и SIGHUP
+    void Run();
+
+    // Завершает Run; можно вызывать из другого потока
+    void Stop();
+
+private:
+    struct Connection {
+        std::string input;
+        output::Writer output;
+        size_t sent = 0;            // отправленная часть output
+        bool closing = false;       // клиент закрыл свою сторону, после отправки соединение закрывается
+        bool waiting_write = false; // ждём готовности сокета к записи вместо чтения
+    };
+
+    void Accept();
+    // Читает доступные данные и выполняет все полученные целиком запросы
+    void Receive(int fd, Connection& connection);
+    // Возвращает false, если соединение пора закрыть
+    bool Send(int fd, Connection& connection);
+    void Watch(int fd, bool for_write);
+    void Close(int fd);
+
+    Handler handler_;
+    ReloadHandler on_reload_;
+    std::string address_;
+    std::string unix_path_;         // удаляется при остановке
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int stop_fd_ = -1;              // eventfd для Stop
+    std::unordered_map<int, Connection> connections_;
+};
+
+} // namespace server
@@ -0,0 +1,210 @@
+#include "spatial_index.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace transport_catalogue {
+
+namespace {
+
+// Запас к радиусу при отборе ячеек: acos в ComputeDistance для близких точек
+// ошибается на доли метра, и точка на границе круга не должна потеряться
+constexpr double kMarginMeters = 1;
+
+// Ячеек не больше, чем столько на остановку
+constexpr size_t kCellsPerStop = 4;
+
+} // namespace
+
+
+SpatialIndex::SpatialIndex(const CatalogueView& catalogue)
+    : catalogue_(catalogue) {
+
+    const size_t stop_count = catalogue_.StopCount();
+    auto indexed = [](Coordinates coordinates) {
+        return std::isfinite(coordinates.lat) && std::isfinite(coordinates.lng);
+    };
+
+    size_t indexed_count = 0;
+    double max_lat = 0;
+    double max_lng = 0;
+    for (StopId stop = 0; stop < stop_count; ++stop) {
+        const Coordinates coordinates = catalogue_.GetStopCoordinates(stop);
+        if (!indexed(coordinates)) {
+            continue;
+        }
+        if (indexed_count++ == 0) {
+            min_lat_ = max_lat = coordinates.lat;
+            min_lng_ = max_lng = coordinates.lng;
+        }
+        min_lat_ = std::min(min_lat_, coordinates.lat);
+        max_lat = std::max(max_lat, coordinates.lat);
+        min_lng_ = std::min(min_lng_, coordinates.lng);
+        max_lng = std::max(max_lng, coordinates.lng);
+    }
+    if (indexed_count == 0) {
+        cell_offsets_.assign(1, 0);
+        return;
+    }
+
+    // Размер ячейки по долготе в метрах на средней широте совпадает с размером по широте
+    const double middle_cos = std::max(std::cos((min_lat_ + max_lat) / 2 * kDegToRad), 0.01);
+    cell_lat_ = kCellMeters / (kEarthRadius * kDegToRad);
+    cell_lng_ = cell_lat_ / middle_cos;
+    while (true) {
+        const double rows = std::floor((max_lat - min_lat_) / cell_lat_) + 1;
+        const double columns = std::floor((max_lng - min_lng_) / cell_lng_) + 1;
+        if (rows * columns <= static_cast<double>(kCellsPerStop * indexed_count + 16)) {
+            rows_ = static_cast<size_t>(rows);
+            columns_ = static_cast<size_t>(columns);
+            break;
+        }
+        cell_lat_ *= 2;
+        cell_lng_ *= 2;
+    }
+
+    auto cell_of = [this](Coordinates coordinates) {
+        const size_t row = std::min(rows_ - 1, static_cast<size_t>((coordinates.lat - min_lat_) / cell_lat_));
+        const size_t column = std::min(columns_ - 1, static_cast<size_t>((coordinates.lng - min_lng_) / cell_lng_));
+        return row * columns_ + column;
+    };
+
+    // Группировка остановок по ячейкам (сортировка подсчётом)
+    cell_offsets_.assign(rows_ * columns_ + 1, 0);
+    for (StopId stop = 0; stop < stop_count; ++stop) {
+        const Coordinates coordinates = catalogue_.GetStopCoordinates(stop);
+        if (indexed(coordinates)) {
+            ++cell_offsets_[cell_of(coordinates) + 1];
+        }
+    }
+    for (size_t i = 1; i < cell_offsets_.size(); ++i) {
+        cell_offsets_[i] += cell_offsets_[i - 1];
+    }
+
+    cell_stops_.resize(indexed_count);
+    cell_points_.resize(indexed_count);
+    std::vector<uint32_t> next(cell_offsets_.begin(), cell_offsets_.end() - 1);
+    for (StopId stop = 0; stop < stop_count; ++stop) {
+        const Coordinates coordinates = catalogue_.GetStopCoordinates(stop);
+        if (!indexed(coordinates)) {
+            continue;
+        }
+        const uint32_t position = next[cell_of(coordinates)]++;
+        cell_stops_[position] = stop;
+        cell_points_[position] = coordinates;
+    }
+}
+
+void SpatialIndex::FindWithin(Coordinates point, double radius, std::vector<NearbyStop>& result) const {
+
+    result.clear();
+    if (!(radius >= 0) || cell_stops_.empty() || !std::isfinite(point.lat) || !std::isfinite(point.lng)) {
+        return;
+    }
+
+    // Угловой радиус круга с запасом
+    const double angle = (radius + kMarginMeters) / kEarthRadius;
+    if (angle >= std::numbers::pi / 2) {
+        // Круг больше полусферы: прямоугольник не сужает поиск
+        for (size_t i = 0; i < cell_stops_.size(); ++i) {
+            const double distance = ComputeDistance(point, cell_points_[i]);
+            if (distance <= radius) {
+                result.push_back({cell_stops_[i], distance});
+            }
+        }
+        SortByDistance(result);
+        return;
+    }
+
+    const double lat_delta = angle / kDegToRad;
+    const double lat_from = point.lat - lat_delta;
+    const double lat_to = point.lat + lat_delta;
+    if (lat_to < min_lat_ || lat_from >= min_lat_ + rows_ * cell_lat_) {
+        return;
+    }
+    const size_t row_from = lat_from <= min_lat_ ? 0 : static_cast<size_t>((lat_from - min_lat_) / cell_lat_);
+    const size_t row_to = lat_to >= min_lat_ + rows_ * cell_lat_
+                              ? rows_ - 1
+                              : std::min(rows_ - 1, static_cast<size_t>((lat_to - min_lat_) / cell_lat_));
+
+    // Наибольшее отклонение по долготе точек круга; круг, задевающий полюс, покрывает все долготы
+    double lng_delta = 180;
+    if (std::abs(point.lat) + lat_delta < 90) {
+        lng_delta = std::asin(std::min(1.0, std::sin(angle) / std::cos(point.lat * kDegToRad))) / kDegToRad;
+    }
+
+    if (lng_delta >= 180) {
+        CollectCells(point, radius, row_from, row_to, point.lng, lat_delta,
+                     std::numeric_limits<double>::infinity(), result);
+    } else {
+        // Круг может переходить через линию смены дат
+        for (const double shift : {-360.0, 0.0, 360.0}) {
+            CollectCells(point, radius, row_from, row_to, point.lng + shift, lat_delta, lng_delta, result);
+        }
+    }
+    SortByDistance(result);
+}
+
+std::optional<NearbyStop> SpatialIndex::FindNearest(Coordinates point) const {
+
+    // Радиус удваивается, пока в круг не попадёт хотя бы одна остановка.
+    // Ближайшая остановка всегда лежит внутри такого круга
+    std::vector<NearbyStop> candidates;
+    const double half_circumference = std::numbers::pi * kEarthRadius;
+    if (!std::isfinite(point.lat) || !std::isfinite(point.lng)) {
+        return std::nullopt;
+    }
+    for (double radius = cell_lat_ * kDegToRad * kEarthRadius; !cell_stops_.empty(); radius *= 2) {
+        FindWithin(point, radius, candidates);
+        if (!candidates.empty()) {
+            return candidates.front();
+        }
+        if (radius > half_circumference) {
+            break;
+        }
+    }
+    return std::nullopt;
+}
+
+void SpatialIndex::CollectCells(Coordinates point, double radius, size_t row_from, size_t row_to,
+                                double center_lng, double lat_delta, double lng_delta,
+                                std::vector<NearbyStop>& result) const {
+
+    const double lng_from = center_lng - lng_delta;
+    const double lng_to = center_lng + lng_delta;
+    if (lng_to < min_lng_ || lng_from >= min_lng_ + columns_ * cell_lng_) {
+        return;
+    }
+    const size_t column_from = lng_from <= min_lng_ ? 0 : static_cast<size_t>((lng_from - min_lng_) / cell_lng_);
+    const size_t column_to = lng_to >= min_lng_ + columns_ * cell_lng_
+                                 ? columns_ - 1
+                                 : std::min(columns_ - 1, static_cast<size_t>((lng_to - min_lng_) / cell_lng_));
+
+    for (size_t row = row_from; row <= row_to; ++row) {
+        // Ячейки одной строки лежат подряд
+        const uint32_t begin = cell_offsets_[row * columns_ + column_from];
+        const uint32_t end = cell_offsets_[row * columns_ + column_to + 1];
+        for (uint32_t i = begin; i < end; ++i) {
+            const Coordinates& stop_point = cell_points_[i];
+            if (std::abs(stop_point.lat - point.lat) > lat_delta || std::abs(stop_point.lng - center_lng) > lng_delta) {
+                continue;
+            }
+            const double distance = ComputeDistance(point, stop_point);
+            if (distance <= radius) {
+                result.push_back({cell_stops_[i], distance});
+            }
+        }
+    }
+}
+
+void SpatialIndex::SortByDistance(std::vector<NearbyStop>& result) const {
+    std::sort(result.begin(), result.end(), [this](const NearbyStop& lhs, const NearbyStop& rhs) {
+        if (lhs.distance != rhs.distance) {
+            return lhs.distance < rhs.distance;
+        }
+        return catalogue_.GetStopName(lhs.stop) < catalogue_.GetStopName(rhs.stop);
+    });
+}
+
+} // namespace transport_catalogue
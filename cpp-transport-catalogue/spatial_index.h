@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "geo.h"
+#include "transport_catalogue.h"
+
+
+namespace transport_catalogue {
+
+struct NearbyStop {
+    StopId stop;
+    double distance;    // метры, по ComputeDistance
+};
+
+/**
+ * Равномерная сетка над координатами остановок для запросов "остановки в радиусе"
+ * и "ближайшая остановка". Ячейки задаются в градусах: по широте около kCellMeters,
+ * по долготе - с поправкой на широту середины справочника. Остановки хранятся
+ * по ячейкам подряд вместе с координатами.
+ *
+ * Запрос просматривает только ячейки, пересекающие описанный вокруг круга
+ * прямоугольник широт и долгот, отсекает остановки вне прямоугольника сравнением
+ * координат и лишь для оставшихся считает ComputeDistance. Результат совпадает
+ * с полным перебором остановок. Остановки с нечисловыми координатами в индекс не входят
+ */
+class SpatialIndex {
+public:
+    // Желаемый размер ячейки; для сильно разнесённых остановок ячейки укрупняются
+    static constexpr double kCellMeters = 250;
+
+    explicit SpatialIndex(const CatalogueView& catalogue);
+
+    /**
+     * Остановки не дальше radius метров от point по возрастанию расстояния,
+     * при равном расстоянии - по названию. Результат записывается в result
+     */
+    void FindWithin(Coordinates point, double radius, std::vector<NearbyStop>& result) const;
+
+    // Ближайшая остановка; при равном расстоянии - с меньшим названием
+    std::optional<NearbyStop> FindNearest(Coordinates point) const;
+
+private:
+    // Добавляет в result остановки из строк [row_from, row_to] в полосе долгот
+    // center_lng ± lng_delta, прошедшие грубую проверку прямоугольником и точную расстоянием
+    void CollectCells(Coordinates point, double radius, size_t row_from, size_t row_to,
+                      double center_lng, double lat_delta, double lng_delta,
+                      std::vector<NearbyStop>& result) const;
+    void SortByDistance(std::vector<NearbyStop>& result) const;
+
+    const CatalogueView& catalogue_;
+
+    double min_lat_ = 0;
+    double min_lng_ = 0;
+    double cell_lat_ = 1;   // размер ячейки, градусы
+    double cell_lng_ = 1;
+    size_t rows_ = 0;
+    size_t columns_ = 0;
+
+    // Остановки ячейки (row, column) занимают [cell_offsets_[row * columns_ + column],
+    // cell_offsets_[row * columns_ + column + 1]) в cell_stops_ и cell_points_
+    std::vector<uint32_t> cell_offsets_;
+    std::vector<StopId> cell_stops_;
+    std::vector<Coordinates> cell_points_;
+};
+
+} // namespace transport_catalogue
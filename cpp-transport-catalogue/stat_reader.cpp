@@ -1,6 +1,9 @@
-#include <iomanip>
 #include "stat_reader.h"
 
+#include <charconv>
+
+#include "metrics.h"
+#include "parallel.h"
 #include "transport_catalogue.h"
 
 using namespace std;
@@ -9,62 +12,339 @@ namespace stat_p{
 
 
 void PrintBusInfo(string_view bus_name, const transport_catalogue::RouteInfo route_info,
-                  ostream& output) {
-
+                  output::Writer& output) {
 
+    METRICS_TIMER("format_output");
     output << "Bus " << bus_name << ": "
            << route_info.stops_count << " stops on route, "
            << route_info.unique_stops_count << " unique stops, "
-           << setprecision(6) << route_info.route_length << " route length, "
+           << route_info.route_length << " route length, "
            << route_info.curvature << " curvature\n";
 
 }
 
-void PrintStopInfo(const transport_catalogue::Stop* stop,
-                   std::set<const transport_catalogue::Bus*, transport_catalogue::BusPtrCompare> buses,
-                   ostream& output) {
+void PrintStopInfo(const transport_catalogue::CatalogueView& catalogue, string_view stop_name,
+                   span<const transport_catalogue::BusId> buses,
+                   output::Writer& output) {
 
+    METRICS_TIMER("format_output");
     if (buses.empty()) {
-        output << "Stop " << stop->name << ": no buses\n";
+        output << "Stop " << stop_name << ": no buses\n";
     } else {
-        output << "Stop " << stop->name << ": buses";
-        for (const auto& bus : buses) {
-            output << " " << bus->name;
+        output << "Stop " << stop_name << ": buses";
+        for (const auto bus : buses) {
+            output << " " << catalogue.GetBusName(bus);
         }
         output << "\n";
     }
 }
 
 
-void ParseAndPrintStat(const transport_catalogue::TransportCatalogue& catalogue,
-                       string_view request, ostream& output) {
+void PrintRouteInfo(const transport_catalogue::CatalogueView& catalogue, string_view from, string_view to,
+                    const router::RouteResult& route, output::Writer& output) {
+
+    METRICS_TIMER("format_output");
+    output << "Route " << from << " to " << to << ": " << route.total_time << " minutes";
+    for (const auto& item : route.items) {
+        if (item.is_wait) {
+            output << "; Wait " << catalogue.GetStopName(item.stop) << " " << item.time;
+        } else {
+            output << "; Bus " << catalogue.GetBusName(item.bus) << " " << item.span_count << " spans " << item.time;
+        }
+    }
+    output << "\n";
+}
+
+
+// Минуты от полуночи как "ЧЧ:ММ", после полуночи часы продолжают счёт
+void PrintClockTime(uint32_t time, output::Writer& output) {
+    const uint32_t hours = time / 60;
+    const uint32_t minutes = time % 60;
+    output << (hours < 10 ? "0" : "") << hours << ':' << (minutes < 10 ? "0" : "") << minutes;
+}
+
+
+void PrintDepartures(const transport_catalogue::CatalogueView& catalogue, string_view stop_name,
+                     string_view time_text, span<const transport_catalogue::Departure> departures,
+                     output::Writer& output) {
+
+    METRICS_TIMER("format_output");
+    output << "Departures " << stop_name << " at " << time_text << ":";
+    if (departures.empty()) {
+        output << " no departures\n";
+        return;
+    }
+    for (size_t i = 0; i < departures.size(); ++i) {
+        output << (i == 0 ? " " : ", ") << catalogue.GetBusName(departures[i].bus) << " ";
+        PrintClockTime(departures[i].time, output);
+    }
+    output << "\n";
+}
+
+
+void PrintNearbyStops(const transport_catalogue::CatalogueView& catalogue, string_view description,
+                      const vector<transport_catalogue::NearbyStop>& stops, output::Writer& output) {
+
+    METRICS_TIMER("format_output");
+    if (stops.empty()) {
+        output << "Nearby " << description << ": no stops\n";
+        return;
+    }
+    output << "Nearby " << description << ": stops";
+    for (size_t i = 0; i < stops.size(); ++i) {
+        output << (i == 0 ? " " : ", ") << catalogue.GetStopName(stops[i].stop) << " " << stops[i].distance;
+    }
+    output << "\n";
+}
+
+/**
+ * Разбирает числа, разделённые запятыми, например "55.61, 37.20, 300".
+ * Возвращает false, если чисел не столько, сколько values, или строка некорректна
+ */
+bool ParseNumbers(string_view text, span<double> values) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        const auto comma = text.find(',');
+        if ((comma == text.npos) != (i + 1 == values.size())) {
+            return false;
+        }
+        string_view number = text.substr(0, comma);
+        while (!number.empty() && number.front() == ' ') number.remove_prefix(1);
+        while (!number.empty() && number.back() == ' ') number.remove_suffix(1);
+        if (!number.empty() && number.front() == '+') number.remove_prefix(1);
+
+        const auto [ptr, ec] = from_chars(number.data(), number.data() + number.size(), values[i]);
+        if (ec != errc() || ptr != number.data() + number.size()) {
+            return false;
+        }
+        text.remove_prefix(comma == text.npos ? text.size() : comma + 1);
+    }
+    return true;
+}
+
+
+optional<BusRequest> BusRequest::Parse(string_view args) {
+    return BusRequest{args};
+}
+
+optional<StopRequest> StopRequest::Parse(string_view args) {
+    return StopRequest{args};
+}
+
+optional<RouteRequest> RouteRequest::Parse(string_view args) {
+    const auto to_pos = args.find(" to ");
+    if (to_pos == args.npos) {
+        return nullopt;
+    }
+    return RouteRequest{args.substr(0, to_pos), args.substr(to_pos + 4)};
+}
+
+optional<NearbyRequest> NearbyRequest::Parse(string_view args) {
+    double values[3];
+    if (!ParseNumbers(args, values)) {
+        return nullopt;
+    }
+    return NearbyRequest{args, {values[0], values[1]}, values[2]};
+}
+
+optional<NearestRequest> NearestRequest::Parse(string_view args) {
+    double values[2];
+    if (!ParseNumbers(args, values)) {
+        return nullopt;
+    }
+    return NearestRequest{args, {values[0], values[1]}};
+}
 
+optional<DeparturesRequest> DeparturesRequest::Parse(string_view args) {
+    const auto at_pos = args.rfind(" at ");
+    if (at_pos == args.npos) {
+        return nullopt;
+    }
+    string_view time_text = args.substr(at_pos + 4);
+    size_t count = kDefaultCount;
+    if (const auto comma = time_text.find(','); comma != time_text.npos) {
+        string_view count_text = time_text.substr(comma + 1);
+        while (!count_text.empty() && count_text.front() == ' ') count_text.remove_prefix(1);
+        const auto [ptr, ec] = from_chars(count_text.data(), count_text.data() + count_text.size(), count);
+        if (ec != errc() || ptr != count_text.data() + count_text.size()) {
+            return nullopt;
+        }
+        time_text = time_text.substr(0, comma);
+    }
+    const auto time = transport_catalogue::ParseClockTime(time_text);
+    if (!time) {
+        return nullopt;
+    }
+    return DeparturesRequest{args.substr(0, at_pos), time_text, *time, count};
+}
 
+StatRequest ParseStatRequest(string_view request) {
     const auto space_pos = request.find(' ');
-    if (space_pos == request.npos) return;
+    if (space_pos == request.npos) {
+        return {};
+    }
+    return StatCommands::Parse(request.substr(0, space_pos), request.substr(space_pos + 1));
+}
+
+namespace {
 
-    const string_view command = request.substr(0, space_pos);
-    const string_view name = request.substr(space_pos + 1);
+// Обработчики разобранных запросов, std::visit выбирает нужный по индексу варианта
+struct StatExecutor {
+    const transport_catalogue::CatalogueView& catalogue;
+    output::Writer& output;
+    const router::TransportRouter* router;
+    const transport_catalogue::SpatialIndex* spatial_index;
+    const transport_catalogue::DepartureBoard* departure_board;
 
-    if (command == "Bus") {
-        const transport_catalogue::RouteInfo  rout_info = catalogue.RouteInformation(name);
+    void operator()(monostate) const {
+    }
+
+    void operator()(const BusRequest& request) const {
+        METRICS_TIMER("query_bus");
+        const transport_catalogue::RouteInfo rout_info = catalogue.RouteInformation(request.name);
         if (rout_info.stops_count > 0) { // Проверяем, что маршрут существует
-            PrintBusInfo( name, rout_info , output);
+            PrintBusInfo(request.name, rout_info, output);
+        } else {
+            output << "Bus " << request.name << ": not found\n";
+        }
+    }
+
+    void operator()(const StopRequest& request) const {
+        METRICS_TIMER("query_stop");
+        if (const auto stop = catalogue.GetStop(request.name)) {
+            const auto buses = catalogue.GetBusesForStop(*stop);
+            PrintStopInfo(catalogue, catalogue.GetStopName(*stop), buses, output);
+        } else {
+            output << "Stop " << request.name << ": not found\n";
+        }
+    }
+
+    void operator()(const RouteRequest& request) const {
+        if (!router) {
+            return;
+        }
+        METRICS_TIMER("query_route");
+        const auto from = catalogue.GetStop(request.from);
+        const auto to = catalogue.GetStop(request.to);
+        const auto route = from && to ? router->BuildRoute(*from, *to) : nullopt;
+        if (route) {
+            PrintRouteInfo(catalogue, request.from, request.to, *route, output);
+        } else {
+            output << "Route " << request.from << " to " << request.to << ": not found\n";
+        }
+    }
+
+    void operator()(const NearbyRequest& request) const {
+        if (!spatial_index) {
+            return;
+        }
+        METRICS_TIMER("query_nearby");
+        // Буфер переиспользуется между запросами одного потока
+        thread_local vector<transport_catalogue::NearbyStop> stops;
+        spatial_index->FindWithin(request.center, request.radius, stops);
+        PrintNearbyStops(catalogue, request.description, stops, output);
+    }
+
+    void operator()(const NearestRequest& request) const {
+        if (!spatial_index) {
+            return;
+        }
+        METRICS_TIMER("query_nearest");
+        if (const auto nearest = spatial_index->FindNearest(request.point)) {
+            output << "Nearest " << request.description << ": " << catalogue.GetStopName(nearest->stop) << " "
+                   << nearest->distance << "\n";
         } else {
-            output << "Bus " << name << ": not found\n";
+            output << "Nearest " << request.description << ": not found\n";
         }
     }
-    else if (command == "Stop") {
-        if (const auto* stop = catalogue.GetStop(name)) {
-            const auto buses = catalogue.GetBusesForStop(name);
-            PrintStopInfo(stop, buses, output);
+
+    void operator()(const DeparturesRequest& request) const {
+        if (!departure_board) {
+            return;
+        }
+        METRICS_TIMER("query_departures");
+        if (const auto stop = catalogue.GetStop(request.stop)) {
+            PrintDepartures(catalogue, request.stop, request.time_text,
+                            departure_board->FindDepartures(*stop, request.time, request.count), output);
         } else {
-            output << "Stop " << name << ": not found\n";
+            output << "Departures " << request.stop << " at " << request.time_text << ": not found\n";
         }
     }
+};
+
+} // namespace
+
+void ExecuteStatRequest(const transport_catalogue::CatalogueView& catalogue, const StatRequest& request,
+                        output::Writer& output, const router::TransportRouter* router,
+                        const transport_catalogue::SpatialIndex* spatial_index,
+                        const transport_catalogue::DepartureBoard* departure_board) {
+
+    visit(StatExecutor{catalogue, output, router, spatial_index, departure_board}, request);
 }
 
+void ParseAndPrintStat(const transport_catalogue::CatalogueView& catalogue,
+                       string_view request, output::Writer& output,
+                       const router::TransportRouter* router,
+                       const transport_catalogue::SpatialIndex* spatial_index,
+                       const transport_catalogue::DepartureBoard* departure_board) {
 
+    ExecuteStatRequest(catalogue, ParseStatRequest(request), output, router, spatial_index, departure_board);
+}
+
+void ParseAndPrintStat(const transport_catalogue::CatalogueView& catalogue,
+                       string_view request, output::Writer& output,
+                       ResponseCache& cache, uint64_t version,
+                       const router::TransportRouter* router,
+                       const transport_catalogue::SpatialIndex* spatial_index,
+                       const transport_catalogue::DepartureBoard* departure_board) {
+
+    if (cache.Lookup(request, version, output)) {
+        return;
+    }
+    // Ответ собирается отдельно: output с дескриптором может сброситься посреди ответа
+    thread_local output::Writer response;
+    response.Clear();
+    ParseAndPrintStat(catalogue, request, response, router, spatial_index, departure_board);
+    cache.Insert(request, version, response.View());
+    output << response.View();
+}
+
+
+void ParseAndPrintStats(const transport_catalogue::CatalogueView& catalogue,
+                        const vector<string_view>& requests,
+                        output::Writer& output, unsigned thread_count,
+                        const router::TransportRouter* router,
+                        const transport_catalogue::SpatialIndex* spatial_index,
+                        const transport_catalogue::DepartureBoard* departure_board,
+                        ResponseCache* cache, uint64_t version) {
+
+    // Потоки берут запросы небольшими блоками, ответы блока копятся в его буфере
+    // и выводятся по порядку блоков. Вперёд вывода обрабатывается не больше
+    // kAheadBlocks блоков, чтобы не держать в памяти ответы на весь поток
+    constexpr size_t kBlockSize = 128;
+    constexpr size_t kAheadBlocks = (1 << 16) / kBlockSize;
+
+    const size_t block_count = (requests.size() + kBlockSize - 1) / kBlockSize;
+    vector<output::Writer> buffers(min(block_count, kAheadBlocks));
+    parallel::ForEachBlockOrdered(
+        block_count, thread_count, buffers.size(),
+        [&](size_t block, unsigned) {
+            auto& buffer = buffers[block % buffers.size()];
+            const size_t end = min(requests.size(), (block + 1) * kBlockSize);
+            for (size_t i = block * kBlockSize; i < end; ++i) {
+                if (cache) {
+                    ParseAndPrintStat(catalogue, requests[i], buffer, *cache, version, router, spatial_index,
+                                      departure_board);
+                } else {
+                    ParseAndPrintStat(catalogue, requests[i], buffer, router, spatial_index, departure_board);
+                }
+            }
+        },
+        [&](size_t block) {
+            auto& buffer = buffers[block % buffers.size()];
+            output << buffer.View();
+            buffer.Clear();
+        });
+}
 
 } //stat_p
 
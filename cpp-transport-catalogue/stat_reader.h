@@ -1,14 +1,130 @@
 #pragma once
 
-#include <iosfwd>
+#include <optional>
 #include <string_view>
+#include <vector>
 
+#include "command_table.h"
+#include "departure_board.h"
+#include "geo.h"
+#include "output_writer.h"
+#include "response_cache.h"
+#include "spatial_index.h"
 #include "transport_catalogue.h"
+#include "transport_router.h"
 
 namespace stat_p {
 
-void ParseAndPrintStat(const transport_catalogue::TransportCatalogue& tansport_catalogue, std::string_view request,
-                       std::ostream& output);
+/**
+ * Разобранные запросы к базе. Строки указывают в текст запроса,
+ * разобранный запрос живёт не дольше него
+ */
+struct BusRequest {
+    static constexpr std::string_view kName = "Bus";
+    static std::optional<BusRequest> Parse(std::string_view args);
+
+    std::string_view name;
+};
+
+struct StopRequest {
+    static constexpr std::string_view kName = "Stop";
+    static std::optional<StopRequest> Parse(std::string_view args);
+
+    std::string_view name;
+};
+
+// Route <откуда> to <куда>
+struct RouteRequest {
+    static constexpr std::string_view kName = "Route";
+    static std::optional<RouteRequest> Parse(std::string_view args);
+
+    std::string_view from;
+    std::string_view to;
+};
+
+// Nearby <широта>, <долгота>, <радиус>
+struct NearbyRequest {
+    static constexpr std::string_view kName = "Nearby";
+    static std::optional<NearbyRequest> Parse(std::string_view args);
+
+    std::string_view description;   // аргументы как есть, повторяются в ответе
+    geo::Coordinates center;
+    double radius;
+};
+
+// Nearest <широта>, <долгота>
+struct NearestRequest {
+    static constexpr std::string_view kName = "Nearest";
+    static std::optional<NearestRequest> Parse(std::string_view args);
+
+    std::string_view description;
+    geo::Coordinates point;
+};
+
+// Departures <остановка> at <ЧЧ:ММ>[, <число отправлений>]
+struct DeparturesRequest {
+    static constexpr std::string_view kName = "Departures";
+    static constexpr size_t kDefaultCount = 5;
+    static std::optional<DeparturesRequest> Parse(std::string_view args);
+
+    std::string_view stop;
+    std::string_view time_text;     // время как в запросе, повторяется в ответе
+    uint32_t time;                  // минуты от полуночи
+    size_t count;
+};
+
+using StatCommands = dispatch::CommandSet<BusRequest, StopRequest, RouteRequest, NearbyRequest, NearestRequest,
+                                          DeparturesRequest>;
+using StatRequest = StatCommands::Parsed;
+
+// Разбирает запрос один раз; неизвестный или некорректный запрос даёт std::monostate
+StatRequest ParseStatRequest(std::string_view request);
+
+/**
+ * Выполняет разобранный запрос. Route выполняется, только если передан router,
+ * Nearby и Nearest - только если передан spatial_index, Departures - только
+ * если передан departure_board, иначе ответа нет
+ */
+void ExecuteStatRequest(const transport_catalogue::CatalogueView& tansport_catalogue, const StatRequest& request,
+                        output::Writer& output, const router::TransportRouter* router = nullptr,
+                        const transport_catalogue::SpatialIndex* spatial_index = nullptr,
+                        const transport_catalogue::DepartureBoard* departure_board = nullptr);
+
+/**
+ * Выполняет запрос "Bus <маршрут>", "Stop <остановка>", "Route <откуда> to <куда>",
+ * "Nearby <широта>, <долгота>, <радиус в метрах>", "Nearest <широта>, <долгота>"
+ * или "Departures <остановка> at <ЧЧ:ММ>[, <число>]":
+ * ParseStatRequest и ExecuteStatRequest за один вызов
+ */
+void ParseAndPrintStat(const transport_catalogue::CatalogueView& tansport_catalogue, std::string_view request,
+                       output::Writer& output, const router::TransportRouter* router = nullptr,
+                       const transport_catalogue::SpatialIndex* spatial_index = nullptr,
+                       const transport_catalogue::DepartureBoard* departure_board = nullptr);
+
+/**
+ * ParseAndPrintStat через кэш ответов: ответ на запрос, уже выполненный
+ * на версии справочника version, копируется из кэша без разбора и выполнения
+ */
+void ParseAndPrintStat(const transport_catalogue::CatalogueView& tansport_catalogue, std::string_view request,
+                       output::Writer& output, ResponseCache& cache, uint64_t version,
+                       const router::TransportRouter* router = nullptr,
+                       const transport_catalogue::SpatialIndex* spatial_index = nullptr,
+                       const transport_catalogue::DepartureBoard* departure_board = nullptr);
+
+/**
+ * Выполняет пачку запросов в thread_count потоках, созданных один раз на пачку.
+ * Потоки разбирают запросы небольшими блоками, ответы блока форматируются в его
+ * буфер, буферы выводятся в порядке блоков, так что результат совпадает
+ * с последовательным вызовом ParseAndPrintStat.
+ * С cache повторы запросов, в том числе внутри пачки, берутся из кэша
+ */
+void ParseAndPrintStats(const transport_catalogue::CatalogueView& tansport_catalogue,
+                        const std::vector<std::string_view>& requests,
+                        output::Writer& output, unsigned thread_count,
+                        const router::TransportRouter* router = nullptr,
+                        const transport_catalogue::SpatialIndex* spatial_index = nullptr,
+                        const transport_catalogue::DepartureBoard* departure_board = nullptr,
+                        ResponseCache* cache = nullptr, uint64_t version = 1);
 
 }
 
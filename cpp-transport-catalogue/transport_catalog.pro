@@ -2,15 +2,33 @@ QT = core
 
 CONFIG += c++20 cmdline
 
+# Без сжатия a * b + c в FMA: geo::ComputePathDistances побитово совпадает с geo::ComputeDistance
+QMAKE_CXXFLAGS += -ffp-contract=off
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Встроенные метрики (metrics.h): таймеры, счётчики и выгрузка по --metrics
+#DEFINES += TRANSPORT_METRICS
+
 SOURCES += \
+    catalogue_snapshot.cpp \
+    compact_catalogue.cpp \
+    contraction_hierarchy.cpp \
+    departure_board.cpp \
+    geo.cpp \
     input_reader.cpp \
+    metrics.cpp \
     main_.cpp \
+    name_interner.cpp \
+    output_writer.cpp \
+    response_cache.cpp \
+    server.cpp \
+    spatial_index.cpp \
     stat_reader.cpp \
-    transport_catalogue.cpp
+    transport_catalogue.cpp \
+    transport_router.cpp
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -18,7 +36,21 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
 HEADERS += \
+    catalogue_snapshot.h \
+    command_table.h \
+    compact_catalogue.h \
+    contraction_hierarchy.h \
+    departure_board.h \
     geo.h \
     input_reader.h \
+    metrics.h \
+    name_interner.h \
+    output_writer.h \
+    parallel.h \
+    response_cache.h \
+    server.h \
+    spatial_index.h \
     stat_reader.h \
-    transport_catalogue.h
+    transport_catalogue.h \
+    transport_router.h \
+    versioned.h
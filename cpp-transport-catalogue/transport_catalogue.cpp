@@ -1,7 +1,10 @@
  #include <unordered_map>
-#include <unordered_set>
-#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 #include "transport_catalogue.h"
+#include "metrics.h"
+#include "parallel.h"
 
 namespace transport_catalogue {
 
@@ -11,33 +14,121 @@ using namespace std;
 
 
 //Добавление дистанции между остановками
-void TransportCatalogue::SetDistance(const Stop* from, const Stop* to, int meters) {
+void TransportCatalogue::SetDistance(StopId from, StopId to, int meters) {
 
-    pair<const Stop*,const Stop*> var = {from, to};
+    pending_distances_[DistanceKey(from, to)] = meters;
 
-    distances_[var] = meters;
+    // Расстояние меняет длину только тех маршрутов, что проходят через from
+    for (BusId bus : GetBusesForStop(from)) {
+        UpdateRouteInfo(bus);
+    }
+}
+
+void TransportCatalogue::RemoveDistance(StopId from, StopId to) {
 
+    pending_distances_[DistanceKey(from, to)] = kNoDistance;
+
+    for (BusId bus : GetBusesForStop(from)) {
+        UpdateRouteInfo(bus);
+    }
 }
 
-int TransportCatalogue::GetDistance(const Stop* from_stop, const Stop* to_stop) const {
+int TransportCatalogue::GetDistance(StopId from_stop, StopId to_stop) const {
 
-    if (distances_.count({from_stop, to_stop}))
-    {
-        return distances_.at({from_stop, to_stop});
+    METRICS_COUNT("distance_lookups", 1);
+    if (auto distance = FindDistance(from_stop, to_stop)) {
+        return *distance;
     }
-    if (distances_.count({to_stop,from_stop}))
-    {
-        return distances_.at({to_stop, from_stop});
+    // Расстояние в обратном направлении
+    METRICS_COUNT("distance_reverse_lookups", 1);
+    if (auto distance = FindDistance(to_stop, from_stop)) {
+        return *distance;
     }
+    METRICS_COUNT("distance_misses", 1);
     return 0;
 }
 
+std::optional<int> TransportCatalogue::FindDistance(StopId from, StopId to) const {
+
+    if (!pending_distances_.empty()) {
+        METRICS_COUNT("distance_pending_probes", 1);
+        if (auto it = pending_distances_.find(DistanceKey(from, to)); it != pending_distances_.end()) {
+            if (it->second == kNoDistance) {
+                return std::nullopt; // удалено, строку индекса не смотрим
+            }
+            return it->second;
+        }
+    }
+
+    if (from + 1 >= distance_offsets_.size()) {
+        return std::nullopt; // Остановка добавлена после построения индекса
+    }
+
+    const auto first = distance_to_.begin() + distance_offsets_[from];
+    const auto last = distance_to_.begin() + distance_offsets_[from + 1];
+    METRICS_COUNT("distance_index_probes", 1);
+    const auto it = std::lower_bound(first, last, to);
+    if (it != last && *it == to) {
+        return distance_meters_[it - distance_to_.begin()];
+    }
+    return std::nullopt;
+}
+
+void TransportCatalogue::BuildDistanceIndex() {
+
+    // Собираем все рёбра: уже проиндексированные и новые.
+    // Новые идут после старых, чтобы при совпадении ключа победило последнее значение
+    struct Edge {
+        StopId from;
+        StopId to;
+        int meters;
+    };
+    std::vector<Edge> edges;
+    edges.reserve(distance_to_.size() + pending_distances_.size());
+
+    for (StopId from = 0; from + 1 < distance_offsets_.size(); ++from) {
+        for (uint32_t i = distance_offsets_[from]; i < distance_offsets_[from + 1]; ++i) {
+            edges.push_back({from, distance_to_[i], distance_meters_[i]});
+        }
+    }
+    for (const auto& [key, meters] : pending_distances_) {
+        edges.push_back({static_cast<StopId>(key >> 32), static_cast<StopId>(key), meters});
+    }
+    pending_distances_.clear();
+
+    std::stable_sort(edges.begin(), edges.end(), [](const Edge& lhs, const Edge& rhs) {
+        return DistanceKey(lhs.from, lhs.to) < DistanceKey(rhs.from, rhs.to);
+    });
+
+    distance_offsets_.assign(stop_names_.size() + 1, 0);
+    distance_to_.clear();
+    distance_meters_.clear();
+    distance_to_.reserve(edges.size());
+    distance_meters_.reserve(edges.size());
+
+    for (size_t i = 0; i < edges.size(); ++i) {
+        if (i + 1 < edges.size() && edges[i + 1].from == edges[i].from && edges[i + 1].to == edges[i].to) {
+            continue;
+        }
+        if (edges[i].meters == kNoDistance) {
+            continue;
+        }
+        distance_to_.push_back(edges[i].to);
+        distance_meters_.push_back(edges[i].meters);
+        ++distance_offsets_[edges[i].from + 1];
+    }
+
+    for (size_t i = 1; i < distance_offsets_.size(); ++i) {
+        distance_offsets_[i] += distance_offsets_[i - 1];
+    }
+}
+
 
 
 void TransportCatalogue::AddDistance (const std::string& name, vector<pair<int, string>>& pvc ){
 
-    // Находим указатель на текущую остановку
-    const Stop* from_stop = GetStop(name);
+    // Находим текущую остановку
+    const auto from_stop = GetStop(name);
 
     if (!from_stop)
     {
@@ -47,13 +138,13 @@ void TransportCatalogue::AddDistance (const std::string& name, vector<pair<int,
     // Добавляем все расстояния из вектора pvc
     for (const auto& [distance, to_stop_name] : pvc) {
 
-        const Stop* to_stop = GetStop(to_stop_name);
+        const auto to_stop = GetStop(to_stop_name);
         if (!to_stop)
         {
             continue;
         }
 
-        SetDistance( from_stop,  to_stop, distance );
+        SetDistance( *from_stop,  *to_stop, distance );
 
 
     }
@@ -63,133 +154,402 @@ void TransportCatalogue::AddDistance (const std::string& name, vector<pair<int,
 }
 
 
-void TransportCatalogue::AddStop(const std::string& name, Coordinates& coordinates) {
+StopId TransportCatalogue::AddStop(std::string_view name, Coordinates coordinates) {
 
-    all_stops_.push_back({name, coordinates});
-    stopname_to_stop_[all_stops_.back().name] = &all_stops_.back();
-    stop_to_buses_[all_stops_.back().name]; // Инициализируем пустое множество
+    const StopId id = static_cast<StopId>(stop_names_.size());
 
+    const auto name_id = names_.Intern(name);
+    stop_names_.push_back(names_.Get(name_id));
+    stop_coordinates_.push_back(coordinates);
+    stop_sin_lat_.push_back(std::sin(coordinates.lat * geo::kDegToRad));
+    stop_cos_lat_.push_back(std::cos(coordinates.lat * geo::kDegToRad));
+    pending_stop_buses_.emplace_back();
+    stop_buses_changed_.push_back(false);
+    if (name_to_stop_.size() <= name_id) {
+        name_to_stop_.resize(name_id + 1, kNoId);
+    }
+    name_to_stop_[name_id] = id;
+
+    return id;
 }
 
 //добавление маршрута
-void TransportCatalogue::AddBus(const std::string& name_number, const std::vector<std::string>& stops, bool is_roundtrip) {
+BusId TransportCatalogue::AddBus(std::string_view name_number, const std::vector<std::string_view>& stops, bool is_roundtrip) {
+    METRICS_TIMER("add_bus");
+
+    for (const auto& stop_name : stops) {
+        if (auto stop = GetStop(stop_name)) {
+            bus_stops_.push_back(*stop);
+        }
+    }
 
-    //all_buses_.push_back({name_number, stops, is_roundtrip});
-    std::vector<const Stop*> bus_stops;
-    bus_stops.reserve(stops.size());
+    return CommitBus(name_number, is_roundtrip);
+}
 
+BusId TransportCatalogue::AddBus(std::string_view name_number, std::span<const StopId> stops, bool is_roundtrip) {
+    METRICS_TIMER("add_bus");
 
-    // Эффективное обновление информации об автобусах для каждой остановки
-    for (const auto& stop_name : stops) {
-        if (auto it = stopname_to_stop_.find(stop_name); it != stopname_to_stop_.end()) {
-            bus_stops.push_back(it->second);
+    bus_stops_.insert(bus_stops_.end(), stops.begin(), stops.end());
+
+    return CommitBus(name_number, is_roundtrip);
+}
+
+// Регистрирует маршрут, остановки которого уже дописаны в конец bus_stops_
+BusId TransportCatalogue::CommitBus(std::string_view name_number, bool is_roundtrip) {
+
+    const BusId id = static_cast<BusId>(bus_names_.size());
+
+    bus_stop_offsets_.push_back(static_cast<uint32_t>(bus_stops_.size()));
+
+    const auto name_id = names_.Intern(name_number);
+    bus_names_.push_back(names_.Get(name_id));
+    bus_is_roundtrip_.push_back(is_roundtrip);
+    if (name_to_bus_.size() <= name_id) {
+        name_to_bus_.resize(name_id + 1, kNoId);
+    }
+    name_to_bus_[name_id] = id;
+
+    pending_bus_stops_.emplace_back();
+    bus_stops_changed_.push_back(false);
+
+    route_info_.push_back({0, 0, 0.0, 0.0});
+    route_info_valid_.push_back(false);
+
+    UpdateStopToBus(id);
+    UpdateRouteInfo(id);
+
+    return id;
+}
+
+void TransportCatalogue::SetStopCoordinates(StopId stop, Coordinates coordinates) {
+
+    stop_coordinates_[stop] = coordinates;
+    stop_sin_lat_[stop] = std::sin(coordinates.lat * geo::kDegToRad);
+    stop_cos_lat_[stop] = std::cos(coordinates.lat * geo::kDegToRad);
+
+    for (BusId bus : GetBusesForStop(stop)) {
+        UpdateRouteInfo(bus);
+    }
+}
+
+void TransportCatalogue::RemoveStop(StopId stop) {
+
+    if (!GetBusesForStop(stop).empty()) {
+        throw std::logic_error("Stop is used by buses");
+    }
+
+    // Имя могло перейти к остановке, добавленной позже с тем же названием
+    if (const auto name_id = names_.Find(stop_names_[stop]); name_id && name_to_stop_[*name_id] == stop) {
+        name_to_stop_[*name_id] = kNoId;
+    }
+    // Остановка без координат не попадает в пространственный индекс
+    SetStopCoordinates(stop, {std::nan(""), std::nan("")});
+}
+
+void TransportCatalogue::SetBusStops(BusId bus, std::span<const StopId> stops, bool is_roundtrip) {
+
+    // stops может указывать на текущие остановки маршрута, поэтому сначала копируем
+    std::vector<StopId> updated(stops.begin(), stops.end());
+    const auto previous_span = GetBusStops(bus);
+    std::vector<StopId> previous(previous_span.begin(), previous_span.end());
+
+    bus_is_roundtrip_[bus] = is_roundtrip;
+    bus_stops_changed_[bus] = true;
+    pending_bus_stops_[bus].assign(updated.begin(), updated.end());
+
+    // Маршрут уходит только из строк остановок, которых в нём больше нет
+    std::sort(updated.begin(), updated.end());
+    std::sort(previous.begin(), previous.end());
+    previous.erase(std::unique(previous.begin(), previous.end()), previous.end());
+    for (StopId stop : previous) {
+        if (!std::binary_search(updated.begin(), updated.end(), stop)) {
+            auto& buses = ChangeStopBuses(stop);
+            buses.erase(std::remove(buses.begin(), buses.end(), bus), buses.end());
         }
     }
 
-    all_buses_.push_back({name_number, std::move(bus_stops), is_roundtrip});
-    busname_to_bus_[all_buses_.back().name] = &all_buses_.back();
+    UpdateStopToBus(bus);
+    UpdateRouteInfo(bus);
+}
+
+void TransportCatalogue::RemoveBus(BusId bus) {
 
-    UpdateStopToBus(name_number, stops);
+    SetBusStops(bus, {}, IsRoundtrip(bus));
+
+    if (const auto name_id = names_.Find(bus_names_[bus]); name_id && name_to_bus_[*name_id] == bus) {
+        name_to_bus_[*name_id] = kNoId;
+    }
 }
 
-void TransportCatalogue::UpdateStopToBus (const std::string& name_number, const std::vector<std::string>& stops){
+// Строка автобусов остановки, которую можно менять: при первом изменении
+// после построения индекса в неё копируется строка индекса
+std::pmr::vector<BusId>& TransportCatalogue::ChangeStopBuses(StopId stop) {
 
-    const Bus* bus_ptr = busname_to_bus_.at(name_number);
+    auto& buses = pending_stop_buses_[stop];
+    if (!stop_buses_changed_[stop]) {
+        const auto indexed = GetBusesForStop(stop);
+        buses.assign(indexed.begin(), indexed.end());
+        stop_buses_changed_[stop] = true;
+    }
+    return buses;
+}
 
-    for (const auto& stop_name : stops) {
-        if (auto it = stopname_to_stop_.find(stop_name); it != stopname_to_stop_.end()) {
-            stop_to_buses_[stop_name].insert(bus_ptr);
+// До первого BuildIndexes() статистика только сбрасывается и потом считается пачкой,
+// после - пересчитывается сразу, чтобы запросы не считали её на лету
+void TransportCatalogue::UpdateRouteInfo(BusId bus) {
+
+    if (indexes_built_) {
+        route_info_[bus] = ComputeRouteInfo(bus);
+        route_info_valid_[bus] = true;
+    } else {
+        route_info_valid_[bus] = false;
+    }
+}
+
+void TransportCatalogue::UpdateStopToBus (BusId bus){
+
+    const auto by_name = [this](BusId lhs, BusId rhs) {
+        return bus_names_[lhs] < bus_names_[rhs];
+    };
+
+    for (StopId stop : GetBusStops(bus)) {
+        auto& buses = ChangeStopBuses(stop);
+        auto it = std::lower_bound(buses.begin(), buses.end(), bus, by_name);
+        // Имена интернированы: одинаковые названия указывают на одну строку
+        if (it == buses.end() || bus_names_[*it].data() != bus_names_[bus].data()) {
+            buses.insert(it, bus);
         }
     }
 
 
 }
 
-const Bus* TransportCatalogue::GetBus(std::string_view name_number) const {
+std::optional<BusId> TransportCatalogue::GetBus(std::string_view name_number) const {
+
+    if (auto name_id = names_.Find(name_number); name_id && *name_id < name_to_bus_.size()
+                                                      && name_to_bus_[*name_id] != kNoId) {
+        return name_to_bus_[*name_id];
+    }
+
+    return std::nullopt;
+}
+
+std::optional<StopId> TransportCatalogue::GetStop(std::string_view name) const {
+
+    if (auto name_id = names_.Find(name); name_id && *name_id < name_to_stop_.size()
+                                               && name_to_stop_[*name_id] != kNoId) {
+        return name_to_stop_[*name_id];
+    }
+
+    return std::nullopt;
+}
+
+size_t TransportCatalogue::StopCount() const {
+    return stop_names_.size();
+}
+
+size_t TransportCatalogue::BusCount() const {
+    return bus_names_.size();
+}
+
+std::string_view TransportCatalogue::GetStopName(StopId stop) const {
+    return stop_names_[stop];
+}
 
-    auto it = busname_to_bus_.find(name_number);
-    if (it != busname_to_bus_.end()) {
-        return it->second;
+Coordinates TransportCatalogue::GetStopCoordinates(StopId stop) const {
+    return stop_coordinates_[stop];
+}
+
+std::string_view TransportCatalogue::GetBusName(BusId bus) const {
+    return bus_names_[bus];
+}
+
+std::span<const StopId> TransportCatalogue::GetBusStops(BusId bus) const {
+    if (bus_stops_changed_[bus]) {
+        return pending_bus_stops_[bus];
     }
+    return std::span<const StopId>(bus_stops_).subspan(
+        bus_stop_offsets_[bus], bus_stop_offsets_[bus + 1] - bus_stop_offsets_[bus]);
+}
 
-    return nullptr;
+bool TransportCatalogue::IsRoundtrip(BusId bus) const {
+    return bus_is_roundtrip_[bus];
 }
 
-const Stop* TransportCatalogue::GetStop(std::string_view name) const {
+std::span<const BusId> CatalogueView::GetBusesForStop(std::string_view stop_name) const {
 
-    auto it = stopname_to_stop_.find(name);
-    if (it != stopname_to_stop_.end()) {
-        return it->second;
+    if (auto stop = GetStop(stop_name)) {
+        return GetBusesForStop(*stop); // Возвращаем автобусы для остановки
     }
 
-    return nullptr;
+    return {}; // Возвращаем пустой список, если остановка не найдена
+}
+
+double CatalogueView::GetSegmentLength(StopId from, StopId to) const {
+
+    if (const int distance = GetDistance(from, to); distance != 0) {
+        return distance;
+    }
+    return ComputeDistance(GetStopCoordinates(from), GetStopCoordinates(to));
 }
 
-std::set<const Bus*, BusPtrCompare> TransportCatalogue::GetBusesForStop(std::string_view stop_name) const {
+std::span<const BusId> TransportCatalogue::GetBusesForStop(StopId stop) const {
 
-    if (auto it = stop_to_buses_.find(stop_name); it != stop_to_buses_.end()) {
-        return it->second; // Возвращаем множество автобусов для остановки
+    if (stop_buses_changed_[stop]) {
+        return pending_stop_buses_[stop];
     }
 
-    return {}; // Возвращаем пустое множество, если остановка не найдена
+    if (stop + 1 < stop_bus_offsets_.size()) {
+        return std::span<const BusId>(stop_bus_ids_).subspan(
+            stop_bus_offsets_[stop], stop_bus_offsets_[stop + 1] - stop_bus_offsets_[stop]);
+    }
+
+    return {};
 }
 
+void TransportCatalogue::BuildStopBusIndex() {
 
+    std::vector<uint32_t> offsets;
+    std::vector<BusId> bus_ids;
+    offsets.reserve(stop_names_.size() + 1);
+    offsets.push_back(0);
 
+    for (StopId stop = 0; stop < stop_names_.size(); ++stop) {
+        const auto buses = GetBusesForStop(stop);
+        bus_ids.insert(bus_ids.end(), buses.begin(), buses.end());
+        offsets.push_back(static_cast<uint32_t>(bus_ids.size()));
+    }
 
-const RouteInfo TransportCatalogue::RouteInformation(const std::string_view& number_name) const {
+    stop_bus_offsets_ = std::move(offsets);
+    stop_bus_ids_ = std::move(bus_ids);
+    stop_bus_ids_.shrink_to_fit();
+
+    // Все строки теперь в индексе, временные списки освобождаем
+    pending_stop_buses_.assign(stop_names_.size(), {});
+    stop_buses_changed_.assign(stop_names_.size(), false);
+}
+
+void TransportCatalogue::CompactBusStops() {
+
+    if (std::find(bus_stops_changed_.begin(), bus_stops_changed_.end(), true) == bus_stops_changed_.end()) {
+        return;
+    }
+
+    std::vector<uint32_t> offsets;
+    std::vector<StopId> stops;
+    offsets.reserve(bus_names_.size() + 1);
+    offsets.push_back(0);
+    for (BusId bus = 0; bus < bus_names_.size(); ++bus) {
+        const auto bus_stops = GetBusStops(bus);
+        stops.insert(stops.end(), bus_stops.begin(), bus_stops.end());
+        offsets.push_back(static_cast<uint32_t>(stops.size()));
+    }
+
+    bus_stop_offsets_ = std::move(offsets);
+    bus_stops_ = std::move(stops);
+    pending_bus_stops_.assign(bus_names_.size(), {});
+    bus_stops_changed_.assign(bus_names_.size(), false);
+}
+
+bool TransportCatalogue::HasPendingUpdates() const {
+    return !pending_distances_.empty()
+           || std::find(stop_buses_changed_.begin(), stop_buses_changed_.end(), true) != stop_buses_changed_.end()
+           || std::find(bus_stops_changed_.begin(), bus_stops_changed_.end(), true) != bus_stops_changed_.end();
+}
+
+
+
+
+const RouteInfo CatalogueView::RouteInformation(const std::string_view& number_name) const {
+
+    const auto bus = GetBus(number_name);
+    if (!bus) {
+        return {0, 0, 0.0, 0.0};
+    }
+
+    return GetRouteInfo(*bus);
+}
+
+RouteInfo TransportCatalogue::GetRouteInfo(BusId bus) const {
+
+    if (route_info_valid_[bus]) {
+        return route_info_[bus];
+    }
+
+    // Кэш ещё не построен или сброшен - считаем на лету
+    return ComputeRouteInfo(bus);
+}
+
+void TransportCatalogue::BuildIndexes(unsigned thread_count) {
+    METRICS_TIMER("build_indexes");
+
+    BuildDistanceIndex();
+    BuildStopBusIndex();
+    CompactBusStops();
+    ComputeRouteStats(thread_count);
+    indexes_built_ = true;
+}
+
+void TransportCatalogue::ComputeRouteStats(unsigned thread_count) {
+
+    // Маршруты независимы, каждый поток пишет только в свои элементы
+    parallel::ForEachChunk(bus_names_.size(), thread_count, [this](size_t begin, size_t end, unsigned) {
+        for (BusId bus = static_cast<BusId>(begin); bus < end; ++bus) {
+            if (!route_info_valid_[bus]) {
+                route_info_[bus] = ComputeRouteInfo(bus);
+                route_info_valid_[bus] = true;
+            }
+        }
+    });
+}
+
+RouteInfo TransportCatalogue::ComputeRouteInfo(BusId bus) const {
 
     RouteInfo info{0, 0, 0.0, 0.0};
 
-    const Bus* bus = GetBus(number_name);
-    if (!bus || bus->stops.empty()) {
+    const auto stops = GetBusStops(bus);
+    if (stops.empty()) {
         return info;
     }
 
-    info.stops_count = bus->stops.size();
-    std::unordered_set<const Stop*> unique_stops(bus->stops.begin(), bus->stops.end());
-    info.unique_stops_count = unique_stops.size();
+    info.stops_count = stops.size();
+
+    // Буферы переиспользуются между маршрутами одного потока
+    thread_local std::vector<StopId> unique_stops;
+    unique_stops.assign(stops.begin(), stops.end());
+    std::sort(unique_stops.begin(), unique_stops.end());
+    info.unique_stops_count = std::unique(unique_stops.begin(), unique_stops.end()) - unique_stops.begin();
+
+    // Географические длины всех отрезков маршрута считаются одним пакетом.
+    // Кольцевой маршрут дополнительно замыкается отрезком от последней остановки к первой
+    const size_t segment_count = bus_is_roundtrip_[bus] ? stops.size() : stops.size() - 1;
+    thread_local std::vector<double> segments_geo;
+    segments_geo.assign(std::max<size_t>(segment_count, 1), 0.0);
+
+    const geo::PointTable points{stop_coordinates_.data(), stop_sin_lat_.data(), stop_cos_lat_.data()};
+    geo::ComputePathDistances(points, stops, segments_geo);
+    if (bus_is_roundtrip_[bus]) {
+        segments_geo[segment_count - 1] =
+            ComputeDistance(stop_coordinates_[stops.back()], stop_coordinates_[stops.front()]);
+    }
 
     double geo_length = 0.0;
     double real_length = 0.0;
 
-    // Для кольцевого маршрута
-    if (bus->is_roundtrip) {
-        for (size_t i = 0; i < bus->stops.size(); ++i) {
-            const Stop* from = bus->stops[i];
-            const Stop* to = bus->stops[(i + 1) % bus->stops.size()];
+    for (size_t i = 0; i < segment_count; ++i) {
+        const StopId from = stops[i];
+        const StopId to = stops[(i + 1) % stops.size()];
 
-            geo_length += ComputeDistance(from->coordinates, to->coordinates);
+        geo_length += segments_geo[i];
 
-            int distance = GetDistance( from, to);
-            if (distance != 0) {
-                real_length += distance;
-            } else {
-                // Если расстояние не найдено, используем географическое расстояние
-                real_length += ComputeDistance(from->coordinates, to->coordinates);
-            }
+        int distance = GetDistance( from, to );
+        if (distance != 0) {
+            real_length += distance;
+        } else {
+            // Если расстояние не найдено, используем географическое расстояние
+            real_length += segments_geo[i];
         }
     }
-    // Для некольцевого маршрута
-    else {
-        // Прямое направление
-        for (size_t i = 0; i < bus->stops.size() - 1; ++i) {
-            const Stop* from = bus->stops[i];
-            const Stop* to = bus->stops[i + 1];
-
-            double segment_geo = ComputeDistance(from->coordinates, to->coordinates);
-            geo_length += segment_geo;
-
-            int distance = GetDistance( from, to );
-            if (distance != 0) {
-                real_length += distance;
-            } else {
-                // Если расстояние не найдено, используем географическое расстояние
-                real_length += segment_geo;
-            }
-        }
-
-    }
 
     info.route_length = real_length;
 
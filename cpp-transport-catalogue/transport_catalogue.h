@@ -1,12 +1,16 @@
 #pragma once
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <optional>
-#include <deque>
-#include <set>
+#include <span>
 #include "geo.h"
+#include "name_interner.h"
 
 
 
@@ -15,17 +19,9 @@ namespace transport_catalogue {
 using namespace geo;
 using namespace std;
 
-struct Stop {
-    std::string name;
-    Coordinates coordinates;
-
-};
-
-struct Bus {
-    std::string name;
-    std::vector<const Stop*> stops;
-    bool is_roundtrip;
-};
+// Остановки и маршруты нумеруются подряд с нуля в порядке добавления
+using StopId = uint32_t;
+using BusId = uint32_t;
 
 struct RouteInfo {
     size_t stops_count;
@@ -34,63 +30,183 @@ struct RouteInfo {
     double curvature;  // отношение фактической длины маршрута к географическому расстоянию
 };
 
-// struct PairHasher {
-//     size_t operator()(const std::pair<std::string_view, std::string_view> pr) const{
-//         auto h1 = std::hash<std::string_view>{}(pr.first);
-//         auto h2 = std::hash<std::string_view>{}(pr.second);
-//         return h1 + h2 * 37;
-//     }
-// };
-
-struct PairHasher {
-    size_t operator()(const std::pair<const Stop*, const Stop*> pr) const {
-        auto h1 = std::hash<const Stop*>{}(pr.first);
-        auto h2 = std::hash<const Stop*>{}(pr.second);
-        return h1 + h2 * 37;
-    }
-};
-
-struct BusPtrCompare {
-    bool operator()(const Bus* lhs, const Bus* rhs) const {
-        return lhs->name < rhs->name;
-    }
-};
 
-
-class TransportCatalogue {
+/**
+ * Интерфейс чтения справочника. Его реализуют и изменяемый TransportCatalogue,
+ * и отображённый в память снимок, поэтому запросы обслуживаются одинаково
+ */
+class CatalogueView {
 public:
+    virtual ~CatalogueView() = default;
+
+    virtual std::optional<BusId> GetBus( std::string_view name) const = 0;
+    virtual std::optional<StopId> GetStop(std::string_view name) const = 0;
 
+    virtual size_t StopCount() const = 0;
+    virtual size_t BusCount() const = 0;
 
-    void AddStop(const std::string& name, Coordinates& coordinates);
-    void AddBus(const std::string& name, const std::vector<std::string>& stops, bool is_roundtrip);
+    virtual std::string_view GetStopName(StopId stop) const = 0;
+    virtual Coordinates GetStopCoordinates(StopId stop) const = 0;
 
-    const Bus* GetBus( std::string_view name) const;
-    const Stop* GetStop(std::string_view name) const;
+    virtual std::string_view GetBusName(BusId bus) const = 0;
+    // Остановки маршрута. Реализация может распаковывать их в буфер потока
+    // (CompactCatalogue), поэтому span действителен только до следующего вызова
+    // GetBusStops в том же потоке - для двух маршрутов сразу нужна копия
+    virtual std::span<const StopId> GetBusStops(BusId bus) const = 0;
+    virtual bool IsRoundtrip(BusId bus) const = 0;
 
-    std::set<const Bus*, BusPtrCompare> GetBusesForStop(std::string_view stop_name) const;
+    // Автобусы, проходящие через остановку, упорядочены по названию.
+    // Возвращается представление внутреннего массива, без копирования
+    std::span<const BusId> GetBusesForStop(std::string_view stop_name) const;
+    virtual std::span<const BusId> GetBusesForStop(StopId stop) const = 0;
 
     const RouteInfo RouteInformation(const std::string_view& number_name) const;
+    virtual RouteInfo GetRouteInfo(BusId bus) const = 0;
 
     //дистанция между остановками
-    void AddDistance (const std::string& name, vector<pair<int, string>>& pvc );
-    void SetDistance(const Stop* from, const Stop* to, int meters);
-    int GetDistance(const Stop* from, const Stop* to) const;
+    virtual int GetDistance(StopId from, StopId to) const = 0;
 
+    // Длина перегона для времени в пути: дорожное расстояние, а если оно
+    // не задано - географическое, как в длине маршрута RouteInformation
+    double GetSegmentLength(StopId from, StopId to) const;
+};
 
-private:
-    void UpdateStopToBus (const std::string& name_number, const std::vector<std::string>& stops);
 
-    std::deque<Bus> all_buses_;
-    std::deque<Stop> all_stops_;
+class TransportCatalogue final : public CatalogueView {
+public:
+    TransportCatalogue() = default;
+    TransportCatalogue(const TransportCatalogue&) = delete;
+    TransportCatalogue& operator=(const TransportCatalogue&) = delete;
+    // Контейнеры ссылаются на пул справочника, поэтому присваивание перемещением запрещено
+    TransportCatalogue(TransportCatalogue&&) = default;
+    TransportCatalogue& operator=(TransportCatalogue&&) = delete;
+
+    StopId AddStop(std::string_view name, Coordinates coordinates);
+    BusId AddBus(std::string_view name, const std::vector<std::string_view>& stops, bool is_roundtrip);
+    // Остановки маршрута уже разрешены в StopId
+    BusId AddBus(std::string_view name, std::span<const StopId> stops, bool is_roundtrip);
+
+    std::optional<BusId> GetBus( std::string_view name) const override;
+    std::optional<StopId> GetStop(std::string_view name) const override;
+
+    size_t StopCount() const override;
+    size_t BusCount() const override;
+
+    std::string_view GetStopName(StopId stop) const override;
+    Coordinates GetStopCoordinates(StopId stop) const override;
+
+    std::string_view GetBusName(BusId bus) const override;
+    std::span<const StopId> GetBusStops(BusId bus) const override;
+    bool IsRoundtrip(BusId bus) const override;
+
+    using CatalogueView::GetBusesForStop;
+    std::span<const BusId> GetBusesForStop(StopId stop) const override;
 
-    std::unordered_map<std::string_view, const Stop*> stopname_to_stop_; //список остановок
-    std::unordered_map<std::string_view, const Bus*> busname_to_bus_; //маршрут
+    RouteInfo GetRouteInfo(BusId bus) const override;
 
-    // Новое поле для хранения автобусов по остановкам
-    std::unordered_map<std::string_view, std::set<const Bus*, BusPtrCompare>> stop_to_buses_;
+    // Строит индекс расстояний и статистику маршрутов, вызывается после загрузки базы.
+    // Изменения через AddBus/SetDistance сбрасывают кэш затронутых маршрутов
+    void BuildIndexes(unsigned thread_count = 1);
 
     //дистанция между остановками
-    std::unordered_map<std::pair<const Stop*, const Stop*>, int,  PairHasher> distances_;  //
+    void AddDistance (const std::string& name, vector<pair<int, string>>& pvc );
+    void SetDistance(StopId from, StopId to, int meters);
+    int GetDistance(StopId from, StopId to) const override;
+
+    /**
+     * Изменения справочника на ходу. Меняются только строки индексов затронутых
+     * остановок и маршрутов: новые строки лежат поверх индексов и сливаются с ними
+     * при следующем BuildIndexes(). После BuildIndexes() статистика затронутых
+     * маршрутов пересчитывается сразу, до него - только сбрасывается.
+     * Номера удалённых остановок и маршрутов не переиспользуются, но по имени
+     * они больше не находятся
+     */
+    void SetStopCoordinates(StopId stop, Coordinates coordinates);
+    // Бросает std::logic_error, если через остановку проходят автобусы
+    void RemoveStop(StopId stop);
+    void SetBusStops(BusId bus, std::span<const StopId> stops, bool is_roundtrip);
+    void RemoveBus(BusId bus);
+    // Расстояние в обратном направлении, если оно задано, снова используется для обоих
+    void RemoveDistance(StopId from, StopId to);
+
+
+private:
+    friend void SaveSnapshot(const TransportCatalogue& catalogue, const std::string& path);
+    friend class CompactCatalogue;
+
+    BusId CommitBus(std::string_view name, bool is_roundtrip);
+    void UpdateStopToBus (BusId bus);
+    std::pmr::vector<BusId>& ChangeStopBuses(StopId stop);
+    void UpdateRouteInfo(BusId bus);
+    bool HasPendingUpdates() const;
+    void CompactBusStops();
+    RouteInfo ComputeRouteInfo(BusId bus) const;
+    void BuildDistanceIndex();
+    void BuildStopBusIndex();
+    void ComputeRouteStats(unsigned thread_count);
+    std::optional<int> FindDistance(StopId from, StopId to) const;
+
+    static uint64_t DistanceKey(StopId from, StopId to) {
+        return (uint64_t{from} << 32) | to;
+    }
+
+    static constexpr uint32_t kNoId = UINT32_MAX;
+    // Значение в pending_distances_ для удалённого расстояния
+    static constexpr int kNoDistance = std::numeric_limits<int>::min();
+
+    // Пул мелких блоков для строк списков, ожидающих BuildIndexes(), и узлов pending_distances_:
+    // при загрузке их сотни тысяч. Пул берёт у кучи крупные куски и отдаёт их целиком
+    // при разрушении справочника. Объявлен первым, чтобы разрушиться последним
+    std::unique_ptr<std::pmr::unsynchronized_pool_resource> pool_ =
+        std::make_unique<std::pmr::unsynchronized_pool_resource>();
+
+    // Названия остановок и маршрутов, каждое различное хранится один раз
+    NameInterner names_;
+    std::vector<StopId> name_to_stop_; // индекс - номер имени, kNoId, если остановки с таким именем нет
+    std::vector<BusId> name_to_bus_;
+
+    // Данные остановок, индекс в каждом массиве - StopId.
+    // Названия указывают в арену names_
+    std::vector<std::string_view> stop_names_;
+    std::vector<Coordinates> stop_coordinates_;
+    std::vector<double> stop_sin_lat_; // предвычислены для пакетного расчёта расстояний
+    std::vector<double> stop_cos_lat_;
+
+    // Автобусы остановок в формате CSR, строится в BuildIndexes(): автобусы остановки i
+    // отсортированы по названию и занимают [stop_bus_offsets_[i], stop_bus_offsets_[i + 1]) в stop_bus_ids_
+    std::vector<uint32_t> stop_bus_offsets_;
+    std::vector<BusId> stop_bus_ids_;
+    // Списки остановок, изменённые после последнего BuildIndexes(), заменяют строку индекса,
+    // если у остановки выставлен флаг в stop_buses_changed_
+    std::pmr::vector<std::pmr::vector<BusId>> pending_stop_buses_{pool_.get()};
+    std::vector<char> stop_buses_changed_;
+
+    // Данные маршрутов, индекс - BusId.
+    // Остановки всех маршрутов лежат подряд в bus_stops_,
+    // остановки маршрута i занимают [bus_stop_offsets_[i], bus_stop_offsets_[i + 1])
+    std::vector<std::string_view> bus_names_;
+    std::vector<uint32_t> bus_stop_offsets_ = {0};
+    std::vector<StopId> bus_stops_;
+    std::vector<bool> bus_is_roundtrip_;
+    // Остановки маршрутов, изменённых после последнего BuildIndexes(), - так же поверх bus_stops_
+    std::pmr::vector<std::pmr::vector<StopId>> pending_bus_stops_{pool_.get()};
+    std::vector<char> bus_stops_changed_;
+
+    // Расстояния, заданные после последнего BuildIndexes(),
+    // ключ - пара (from, to), упакованная в 64 бита
+    std::pmr::unordered_map<uint64_t, int> pending_distances_{pool_.get()};
+
+    // Индекс расстояний в формате CSR: соседи остановки i отсортированы по StopId
+    // и занимают [distance_offsets_[i], distance_offsets_[i + 1]) в distance_to_ и distance_meters_
+    std::vector<uint32_t> distance_offsets_;
+    std::vector<StopId> distance_to_;
+    std::vector<int> distance_meters_;
+
+    // Кэш статистики маршрутов
+    std::vector<RouteInfo> route_info_;
+    std::vector<char> route_info_valid_; // не vector<bool>: заполняется из нескольких потоков
+
+    bool indexes_built_ = false;
 };
 
 
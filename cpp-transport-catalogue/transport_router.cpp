@@ -0,0 +1,283 @@
+#include "transport_router.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+#include "parallel.h"
+
+namespace router {
+
+namespace {
+
+constexpr uint32_t kNoEdge = std::numeric_limits<uint32_t>::max();
+
+// Состояние поиска переиспользуется между запросами одного потока.
+// После запроса сбрасываются только затронутые вершины
+struct SearchState {
+    std::vector<PathCost> time;
+    std::vector<uint32_t> prev_edge;
+    std::vector<StopId> touched;
+    std::vector<std::pair<PathCost, StopId>> heap;
+    std::vector<uint32_t> path;
+
+    void Prepare(size_t vertex_count) {
+        if (time.size() < vertex_count) {
+            time.resize(vertex_count, kInfiniteCost);
+            prev_edge.resize(vertex_count, kNoEdge);
+        }
+    }
+
+    void Reset() {
+        for (StopId stop : touched) {
+            time[stop] = kInfiniteCost;
+            prev_edge[stop] = kNoEdge;
+        }
+        touched.clear();
+        heap.clear();
+        path.clear();
+    }
+};
+
+thread_local SearchState search_state;
+
+// Вес ребра для поиска: время в долях минуты и 40-битный ключ из номера ребра (splitmix64).
+// Сумма ключей не переполняется на путях короче 2^24 рёбер
+PathCost MakeCost(double minutes, uint32_t edge) {
+    uint64_t key = edge + 0x9E3779B97F4A7C15ull;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+    key ^= key >> 31;
+    return {std::llround(minutes * PathCost::kTimeScale), key >> 24};
+}
+
+// Дейкстра из from; поиск останавливается, когда до to найден кратчайший путь.
+// Для to = kNoStop просматривается весь граф
+constexpr StopId kNoStop = std::numeric_limits<StopId>::max();
+
+void RunSearch(std::span<const uint32_t> edge_offsets, std::span<const TransportRouter::Edge> edges,
+               StopId from, StopId to, SearchState& state) {
+
+    auto relax = [&state](StopId stop, PathCost time, uint32_t edge) {
+        if (state.time[stop] == kInfiniteCost) {
+            state.touched.push_back(stop);
+        }
+        state.time[stop] = time;
+        state.prev_edge[stop] = edge;
+        state.heap.emplace_back(time, stop);
+        std::push_heap(state.heap.begin(), state.heap.end(), std::greater<>{});
+    };
+
+    relax(from, PathCost{}, kNoEdge);
+    while (!state.heap.empty()) {
+        std::pop_heap(state.heap.begin(), state.heap.end(), std::greater<>{});
+        const auto [time, stop] = state.heap.back();
+        state.heap.pop_back();
+
+        if (time > state.time[stop]) {
+            continue; // устаревшая запись
+        }
+        if (stop == to) {
+            break;
+        }
+
+        for (uint32_t edge = edge_offsets[stop]; edge < edge_offsets[stop + 1]; ++edge) {
+            const PathCost next_time = time + edges[edge].cost;
+            if (next_time < state.time[edges[edge].to]) {
+                relax(edges[edge].to, next_time, edge);
+            }
+        }
+    }
+}
+
+} // namespace
+
+
+TransportRouter::TransportRouter(const transport_catalogue::CatalogueView& catalogue, RoutingSettings settings)
+    : catalogue_(catalogue)
+    , settings_(settings) {
+
+    std::vector<Edge> edges;
+    for (BusId bus = 0; bus < catalogue_.BusCount(); ++bus) {
+        const auto stops = catalogue_.GetBusStops(bus);
+        if (catalogue_.IsRoundtrip(bus)) {
+            AddBusEdges(bus, stops, edges);
+        } else {
+            // Некольцевой маршрут хранится как A-B-C-B-A: туда и обратно отдельно
+            const size_t middle = stops.size() / 2;
+            AddBusEdges(bus, stops.first(std::min(stops.size(), middle + 1)), edges);
+            AddBusEdges(bus, stops.subspan(middle), edges);
+        }
+    }
+
+    // Группировка рёбер по начальной остановке (сортировка подсчётом)
+    const size_t vertex_count = catalogue_.StopCount();
+    edge_offsets_.assign(vertex_count + 1, 0);
+    for (const Edge& edge : edges) {
+        ++edge_offsets_[edge.from + 1];
+    }
+    for (size_t i = 1; i < edge_offsets_.size(); ++i) {
+        edge_offsets_[i] += edge_offsets_[i - 1];
+    }
+
+    edges_.resize(edges.size());
+    std::vector<uint32_t> next(edge_offsets_.begin(), edge_offsets_.end() - 1);
+    for (const Edge& edge : edges) {
+        edges_[next[edge.from]++] = edge;
+    }
+    for (uint32_t edge = 0; edge < edges_.size(); ++edge) {
+        edges_[edge].cost = MakeCost(edges_[edge].weight, edge);
+    }
+}
+
+void TransportRouter::AddBusEdges(BusId bus, std::span<const StopId> stops, std::vector<Edge>& edges) const {
+
+    // метров в минуту
+    const double velocity = settings_.bus_velocity * 1000.0 / 60.0;
+
+    for (size_t i = 0; i + 1 < stops.size(); ++i) {
+        double meters = 0;
+        for (size_t j = i + 1; j < stops.size(); ++j) {
+            const StopId prev = stops[j - 1];
+            const StopId stop = stops[j];
+
+            meters += catalogue_.GetSegmentLength(prev, stop);
+
+            edges.push_back({stops[i], stop, bus, static_cast<uint32_t>(j - i),
+                             settings_.bus_wait_time + meters / velocity, {}});
+        }
+    }
+}
+
+void TransportRouter::Precompute(PrecomputeMode mode, unsigned thread_count) {
+
+    const auto start = std::chrono::steady_clock::now();
+
+    all_pairs_prev_edge_ = {};
+    hierarchy_.reset();
+    const bool automatic = mode == PrecomputeMode::kAuto;
+    if (automatic) {
+        mode = VertexCount() <= kAllPairsMaxStops ? PrecomputeMode::kAllPairs : PrecomputeMode::kContraction;
+    }
+
+    precompute_stats_ = {};
+    if (mode == PrecomputeMode::kAllPairs) {
+        BuildAllPairs(thread_count);
+        precompute_stats_.memory_bytes = all_pairs_prev_edge_.capacity() * sizeof(uint32_t);
+    } else if (mode == PrecomputeMode::kContraction) {
+        std::vector<ContractionHierarchy::InputEdge> edges;
+        edges.reserve(edges_.size());
+        for (const Edge& edge : edges_) {
+            edges.push_back({edge.from, edge.to, edge.cost});
+        }
+        hierarchy_ = std::make_unique<ContractionHierarchy>(VertexCount(), edges);
+        precompute_stats_.memory_bytes = hierarchy_->MemoryBytes();
+
+        // Если несжатым осталось больше половины графа, запрос по иерархии
+        // не быстрее Дейкстры, и в автоматическом режиме она не используется
+        if (automatic && hierarchy_->CoreSize() * 2 > VertexCount()) {
+            hierarchy_.reset();
+            precompute_stats_.memory_bytes = 0;
+            mode = PrecomputeMode::kNone;
+        }
+    }
+
+    precompute_stats_.mode = mode;
+    precompute_stats_.build_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void TransportRouter::BuildAllPairs(unsigned thread_count) {
+
+    const size_t vertex_count = VertexCount();
+    all_pairs_prev_edge_.assign(vertex_count * vertex_count, kNoEdge);
+
+    // Строка таблицы - дерево кратчайших путей Дейкстры из одной остановки.
+    // Ранняя остановка поиска не меняет рёбер уже найденных вершин,
+    // поэтому пути из таблицы совпадают с путями BuildRouteDijkstra
+    parallel::ForEachChunk(vertex_count, thread_count, [&](size_t begin, size_t end, unsigned) {
+        SearchState& state = search_state;
+        state.Prepare(vertex_count);
+        for (size_t from = begin; from < end; ++from) {
+            RunSearch(edge_offsets_, edges_, static_cast<StopId>(from), kNoStop, state);
+            std::copy(state.prev_edge.begin(), state.prev_edge.begin() + vertex_count,
+                      all_pairs_prev_edge_.begin() + from * vertex_count);
+            state.Reset();
+        }
+    });
+}
+
+std::optional<RouteResult> TransportRouter::BuildRoute(StopId from, StopId to) const {
+    if (!all_pairs_prev_edge_.empty()) {
+        return RouteFromAllPairs(from, to);
+    }
+    if (hierarchy_) {
+        return RouteFromHierarchy(from, to);
+    }
+    return BuildRouteDijkstra(from, to);
+}
+
+std::optional<RouteResult> TransportRouter::BuildRouteDijkstra(StopId from, StopId to) const {
+
+    SearchState& state = search_state;
+    state.Prepare(VertexCount());
+
+    RunSearch(edge_offsets_, edges_, from, to, state);
+
+    std::optional<RouteResult> result;
+    if (state.time[to] != kInfiniteCost) {
+        for (uint32_t edge = state.prev_edge[to]; edge != kNoEdge; edge = state.prev_edge[edges_[edge].from]) {
+            state.path.push_back(edge);
+        }
+        std::reverse(state.path.begin(), state.path.end());
+        result = MakeRoute(state.path);
+    }
+
+    state.Reset();
+    return result;
+}
+
+std::optional<RouteResult> TransportRouter::RouteFromAllPairs(StopId from, StopId to) const {
+
+    const uint32_t* row = all_pairs_prev_edge_.data() + static_cast<size_t>(from) * VertexCount();
+    if (from != to && row[to] == kNoEdge) {
+        return std::nullopt;
+    }
+
+    std::vector<uint32_t>& path = search_state.path;
+    for (uint32_t edge = from != to ? row[to] : kNoEdge; edge != kNoEdge; edge = row[edges_[edge].from]) {
+        path.push_back(edge);
+    }
+    std::reverse(path.begin(), path.end());
+    RouteResult result = MakeRoute(path);
+    path.clear();
+    return result;
+}
+
+std::optional<RouteResult> TransportRouter::RouteFromHierarchy(StopId from, StopId to) const {
+
+    std::vector<uint32_t>& path = search_state.path;
+    std::optional<RouteResult> result;
+    if (hierarchy_->FindPath(from, to, path)) {
+        result = MakeRoute(path);
+    }
+    path.clear();
+    return result;
+}
+
+RouteResult TransportRouter::MakeRoute(std::span<const uint32_t> path_edges) const {
+
+    RouteResult result;
+    result.items.reserve(path_edges.size() * 2);
+
+    for (uint32_t edge_id : path_edges) {
+        const Edge& edge = edges_[edge_id];
+        result.items.push_back({true, edge.from, 0, 0, settings_.bus_wait_time});
+        result.items.push_back({false, edge.from, edge.bus, edge.span_count, edge.weight - settings_.bus_wait_time});
+        result.total_time += edge.weight;
+    }
+    return result;
+}
+
+} // namespace router
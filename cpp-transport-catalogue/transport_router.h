@@ -0,0 +1,143 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+#include "contraction_hierarchy.h"
+#include "transport_catalogue.h"
+
+
+namespace router {
+
+using transport_catalogue::BusId;
+using transport_catalogue::StopId;
+
+struct RoutingSettings {
+    double bus_wait_time = 6;   // ожидание автобуса на остановке, минуты
+    double bus_velocity = 40;   // скорость автобуса, км/ч
+};
+
+/**
+ * Предварительный расчёт для быстрых запросов Route:
+ *   kNone        - каждый запрос выполняется алгоритмом Дейкстры
+ *   kAllPairs    - таблица последних рёбер кратчайших путей для всех пар остановок,
+ *                  запрос - проход по цепочке рёбер; память квадратична по числу остановок
+ *   kContraction - иерархия сжатий, запрос просматривает малую часть графа
+ *   kAuto        - таблица для небольших справочников, иначе иерархия сжатий,
+ *                  если в графе нашлась иерархия; иначе остаётся Дейкстра
+ */
+enum class PrecomputeMode {
+    kNone,
+    kAuto,
+    kAllPairs,
+    kContraction,
+};
+
+struct PrecomputeStats {
+    PrecomputeMode mode = PrecomputeMode::kNone;   // выбранный способ, kAuto не бывает
+    double build_seconds = 0;
+    size_t memory_bytes = 0;
+};
+
+struct RouteItem {
+    bool is_wait;           // ожидание на остановке stop или поездка на автобусе bus
+    StopId stop;            // остановка ожидания или посадки
+    BusId bus;
+    uint32_t span_count;    // число перегонов поездки
+    double time;            // минуты
+};
+
+struct RouteResult {
+    double total_time = 0;  // минуты
+    std::vector<RouteItem> items;
+};
+
+/**
+ * Поиск самого быстрого пути между остановками.
+ * Граф строится один раз: из каждой остановки маршрута есть ребро в каждую следующую
+ * остановку того же направления, вес ребра - ожидание автобуса плюс время поездки
+ * по дорожным расстояниям. Некольцевой маршрут даёт два независимых направления,
+ * проехать через конечную без пересадки нельзя.
+ * Запросы выполняются алгоритмом Дейкстры; состояние поиска своё у каждого потока
+ * и переиспользуется между запросами. Поиск сравнивает пути по PathCost, поэтому
+ * кратчайший путь единственный, и после Precompute таблица и иерархия сжатий
+ * дают тот же маршрут, что и Дейкстра
+ */
+class TransportRouter {
+public:
+    TransportRouter(const transport_catalogue::CatalogueView& catalogue, RoutingSettings settings);
+
+    // Таблица всех пар выбирается в режиме kAuto при числе остановок не больше этого
+    static constexpr size_t kAllPairsMaxStops = 2048;
+
+    /**
+     * Строит структуры для быстрых запросов. Вызывается до запросов, не одновременно с ними.
+     * Таблица всех пар считается в thread_count потоков
+     */
+    void Precompute(PrecomputeMode mode, unsigned thread_count = 1);
+
+    const PrecomputeStats& GetPrecomputeStats() const {
+        return precompute_stats_;
+    }
+
+    std::optional<RouteResult> BuildRoute(StopId from, StopId to) const;
+
+    // Запрос алгоритмом Дейкстры без предварительного расчёта
+    std::optional<RouteResult> BuildRouteDijkstra(StopId from, StopId to) const;
+
+    const RoutingSettings& GetSettings() const {
+        return settings_;
+    }
+
+    size_t VertexCount() const {
+        return edge_offsets_.size() - 1;
+    }
+
+    size_t EdgeCount() const {
+        return edges_.size();
+    }
+
+    // Описание ребра графа: поездка на автобусе bus от from до to через span_count перегонов
+    struct Edge {
+        StopId from;
+        StopId to;
+        BusId bus;
+        uint32_t span_count;
+        double weight;      // минуты, включая ожидание
+        PathCost cost;      // weight для поиска, с ключом ребра
+    };
+
+    const Edge& GetEdge(uint32_t edge) const {
+        return edges_[edge];
+    }
+
+    // Рёбра, выходящие из остановки
+    std::span<const Edge> GetOutgoingEdges(StopId stop) const {
+        return std::span<const Edge>(edges_).subspan(edge_offsets_[stop], edge_offsets_[stop + 1] - edge_offsets_[stop]);
+    }
+
+    // Собирает ответ по цепочке рёбер пути
+    RouteResult MakeRoute(std::span<const uint32_t> path_edges) const;
+
+private:
+    void AddBusEdges(BusId bus, std::span<const StopId> stops, std::vector<Edge>& edges) const;
+    void BuildAllPairs(unsigned thread_count);
+    std::optional<RouteResult> RouteFromAllPairs(StopId from, StopId to) const;
+    std::optional<RouteResult> RouteFromHierarchy(StopId from, StopId to) const;
+
+    const transport_catalogue::CatalogueView& catalogue_;
+    RoutingSettings settings_;
+
+    // Рёбра сгруппированы по начальной остановке:
+    // рёбра из остановки i занимают [edge_offsets_[i], edge_offsets_[i + 1]) в edges_
+    std::vector<uint32_t> edge_offsets_;
+    std::vector<Edge> edges_;
+
+    PrecomputeStats precompute_stats_;
+    // Для пары (from, to) - последнее ребро кратчайшего пути, строка на каждую from
+    std::vector<uint32_t> all_pairs_prev_edge_;
+    std::unique_ptr<ContractionHierarchy> hierarchy_;
+};
+
+} // namespace router
@@ -0,0 +1,166 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace parallel {
+
+/**
+ * Неизменяемое значение, которое писатель заменяет целиком, а читатели
+ * читают без блокировок (схема RCU с эпохами).
+ *
+ * Читатель занимает ячейку и записывает в неё текущую эпоху, после чего берёт
+ * указатель на текущую версию - это одна CAS, одно чтение и одна запись при
+ * освобождении, без общих счётчиков ссылок. Писатель подменяет указатель,
+ * увеличивает эпоху и откладывает старую версию; она удаляется, когда ни одна
+ * занятая ячейка не хранит эпоху меньше эпохи её замены. Писатели выполняются
+ * по одному, читателей они не ждут.
+ *
+ * Одновременно живых ReadGuard может быть не больше kSlotCount,
+ * лишние читатели ждут освобождения ячейки
+ */
+template <typename T>
+class Versioned {
+public:
+    static constexpr size_t kSlotCount = 128;
+
+    explicit Versioned(std::unique_ptr<const T> initial)
+        : current_(new Node{std::move(initial), 1}) {
+    }
+
+    Versioned(const Versioned&) = delete;
+    Versioned& operator=(const Versioned&) = delete;
+
+    // К моменту удаления читателей быть не должно
+    ~Versioned() {
+        for (const auto& [node, epoch] : retired_) {
+            delete node;
+        }
+        delete current_.load();
+    }
+
+    // Версия остаётся живой, пока существует ReadGuard
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept
+            : owner_(std::exchange(other.owner_, nullptr))
+            , slot_(other.slot_)
+            , node_(other.node_) {
+        }
+        ReadGuard& operator=(ReadGuard&&) = delete;
+
+        ~ReadGuard() {
+            if (owner_) {
+                owner_->slots_[slot_].epoch.store(0);
+            }
+        }
+
+        const T& operator*() const {
+            return *node_->value;
+        }
+        const T* operator->() const {
+            return node_->value.get();
+        }
+
+        // Номер версии: 1 у начальной, каждая Publish увеличивает на единицу
+        uint64_t Version() const {
+            return node_->version;
+        }
+
+    private:
+        friend class Versioned;
+
+        ReadGuard(const Versioned* owner, size_t slot, const typename Versioned::Node* node)
+            : owner_(owner)
+            , slot_(slot)
+            , node_(node) {
+        }
+
+        const Versioned* owner_;
+        size_t slot_;
+        const typename Versioned::Node* node_;
+    };
+
+    ReadGuard Read() const {
+        // Каждый поток начинает поиск свободной ячейки со своей, чтобы не толкаться
+        thread_local const size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        while (true) {
+            for (size_t i = 0; i < kSlotCount; ++i) {
+                const size_t slot = (hint + i) % kSlotCount;
+                uint64_t expected = 0;
+                if (slots_[slot].epoch.compare_exchange_strong(expected, epoch_.load())) {
+                    return ReadGuard(this, slot, current_.load());
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * Публикует новую версию и возвращает её номер. Читатели, уже взявшие
+     * прежнюю версию, дочитывают её; новые читатели видят только новую
+     */
+    uint64_t Publish(std::unique_ptr<const T> next) {
+        std::lock_guard lock(writer_mutex_);
+
+        const uint64_t version = epoch_.load() + 1;
+        Node* previous = current_.exchange(new Node{std::move(next), version});
+        epoch_.store(version);
+        retired_.emplace_back(previous, version);
+
+        ReclaimLocked();
+        return version;
+    }
+
+    // Удаляет дочитанные версии, возвращает число ещё ожидающих
+    size_t Reclaim() {
+        std::lock_guard lock(writer_mutex_);
+        return ReclaimLocked();
+    }
+
+private:
+    struct Node {
+        std::unique_ptr<const T> value;
+        uint64_t version;
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0}; // 0 - ячейка свободна
+    };
+
+    size_t ReclaimLocked() {
+        uint64_t oldest_reader = UINT64_MAX;
+        for (const Slot& slot : slots_) {
+            if (const uint64_t epoch = slot.epoch.load(); epoch != 0) {
+                oldest_reader = std::min(oldest_reader, epoch);
+            }
+        }
+
+        // Версию, заменённую в эпоху epoch, мог взять только читатель с эпохой меньше epoch
+        std::erase_if(retired_, [oldest_reader](const std::pair<Node*, uint64_t>& retired) {
+            if (retired.second <= oldest_reader) {
+                delete retired.first;
+                return true;
+            }
+            return false;
+        });
+        return retired_.size();
+    }
+
+    mutable std::array<Slot, kSlotCount> slots_;
+    std::atomic<Node*> current_;
+    std::atomic<uint64_t> epoch_{1};
+
+    std::mutex writer_mutex_;
+    std::vector<std::pair<Node*, uint64_t>> retired_; // версия и эпоха её замены
+};
+
+} // namespace parallel